@@ -0,0 +1,57 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <neo/gradient.hpp>
+#include <thread>
+
+static constexpr std::size_t strip_num_leds = 600;
+static constexpr std::size_t num_rounds = 100;
+
+using namespace std::chrono_literals;
+
+/**
+ * Blends two strips pixel by pixel with `blend_fn`, at a different factor each round, and logs the time per pixel.
+ */
+template <class BlendFn>
+void benchmark_blend(const char *name, std::vector<neo::srgb> const &l, std::vector<neo::srgb> const &r,
+                     std::vector<neo::srgb> &out, BlendFn const &blend_fn) {
+    const std::int64_t start = esp_timer_get_time();
+    for (std::size_t i = 0; i < num_rounds; ++i) {
+        const float t = float(i) / float(num_rounds - 1);
+        for (std::size_t j = 0; j < out.size(); ++j) {
+            out[j] = blend_fn(l[j], r[j], t);
+        }
+    }
+    const std::int64_t elapsed = esp_timer_get_time() - start;
+    ESP_LOGI("NEO", "%s: %lld ns/pixel.", name, (long long) (elapsed * 1000 / std::int64_t(num_rounds * out.size())));
+}
+
+extern "C" [[noreturn]] void app_main() {
+    std::vector<neo::srgb> l{strip_num_leds};
+    std::vector<neo::srgb> r{strip_num_leds};
+    std::vector<neo::srgb> out{strip_num_leds};
+    for (std::size_t i = 0; i < strip_num_leds; ++i) {
+        l[i] = neo::srgb{std::uint8_t(i), std::uint8_t(3 * i), std::uint8_t(7 * i)};
+        r[i] = neo::srgb{std::uint8_t(255 - i), std::uint8_t(5 * i), std::uint8_t(11 * i)};
+    }
+
+    benchmark_blend("blend_linear", l, r, out, neo::blend_linear);
+    benchmark_blend("blend_linear_lut", l, r, out, neo::blend_linear_lut);
+
+    // The largest difference between the two, over all channels of all the blended pixels
+    int max_error = 0;
+    for (std::size_t i = 0; i < num_rounds; ++i) {
+        const float t = float(i) / float(num_rounds - 1);
+        for (std::size_t j = 0; j < strip_num_leds; ++j) {
+            const neo::srgb expected = neo::blend_linear(l[j], r[j], t);
+            const neo::srgb actual = neo::blend_linear_lut(l[j], r[j], t);
+            for (neo::channel chn : {neo::channel::r, neo::channel::g, neo::channel::b}) {
+                max_error = std::max(max_error, std::abs(int(expected[chn]) - int(actual[chn])));
+            }
+        }
+    }
+    ESP_LOGI("NEO", "blend_linear_lut differs from blend_linear by at most %d.", max_error);
+
+    while (true) {
+        std::this_thread::sleep_for(1s);
+    }
+}
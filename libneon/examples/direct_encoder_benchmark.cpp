@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <neo/color.hpp>
+#include <neo/encoder.hpp>
+#include <neo/extractor.hpp>
+#include <sdkconfig.h>
+#include <thread>
+#include <vector>
+
+static_assert(LIBNEON_DIRECT_TRANSMIT, "This example requires ESP-IDF 5.3 or later, without CONFIG_RMT_ISR_IRAM_SAFE.");
+
+static constexpr std::size_t strip_num_leds = 300;
+static constexpr std::size_t num_frames = 100;
+static constexpr gpio_num_t strip_gpio_pin = GPIO_NUM_13;
+
+using namespace std::chrono_literals;
+
+/**
+ * Refills the frame like the RMT interrupt does, half of the channel memory at a time, and logs the average and worst
+ * CPU cycles per refill. A refill must take less than the other half of the memory takes on the wire.
+ * @note A refill of a few LEDs is well below the microsecond resolution of `esp_timer_get_time`, hence the cycles.
+ */
+void benchmark_refill(const char *name, neo::direct_frame const &frame, std::size_t mem_block_symbols, std::chrono::nanoseconds bit_period) {
+    // Same as the simple encoder: half the memory, but at least one whole LED
+    const std::size_t refill_symbols = std::max(mem_block_symbols / 2, frame.symbols_per_led());
+    std::vector<rmt_symbol_word_t> block(refill_symbols);
+    std::uint64_t total_cycles = 0;
+    std::uint32_t worst_cycles = 0;
+    std::size_t num_refills = 0;
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        std::size_t symbols_written = 0;
+        bool done = false;
+        while (not done) {
+            const std::uint32_t start = esp_cpu_get_cycle_count();
+            symbols_written += frame.encode(symbols_written, block.size(), block.data(), done);
+            const std::uint32_t elapsed = esp_cpu_get_cycle_count() - start;
+            total_cycles += elapsed;
+            worst_cycles = std::max(worst_cycles, elapsed);
+            ++num_refills;
+        }
+    }
+    const auto wire_cycles = std::uint64_t(bit_period.count()) * refill_symbols * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ / 1000;
+    ESP_LOGI("NEO", "%s: %llu cycles/refill on average, %lu at worst, %llu cycles on the wire per %d symbols.", name,
+             (unsigned long long) (total_cycles / num_refills), (unsigned long) worst_cycles, (unsigned long long) wire_cycles,
+             int(refill_symbols));
+}
+
+extern "C" [[noreturn]] void app_main() {
+    const neo::encoding_spec spec = neo::encoding::ws2812b;
+    const rmt_tx_channel_config_t config = neo::make_rmt_config(strip_gpio_pin);
+    neo::led_encoder encoder{spec, config};
+
+    std::vector<neo::srgb> colors{strip_num_leds};
+    std::vector<neo::linear_rgb16> linear_colors{strip_num_leds};
+    for (std::size_t i = 0; i < strip_num_leds; ++i) {
+        colors[i] = neo::srgb{std::uint8_t(i), std::uint8_t(2 * i), std::uint8_t(3 * i)};
+        linear_colors[i] = neo::linear_rgb16{colors[i]};
+    }
+
+    const auto gamma = neo::srgb_gamma_channel_extractor(1.2f);
+    const auto linear = neo::linear_channel_extractor();
+
+    const std::chrono::nanoseconds bit_period = spec.t1h + spec.t1l;
+    benchmark_refill("srgb, default", encoder.make_direct_frame(colors), config.mem_block_symbols, bit_period);
+    benchmark_refill("srgb, gamma", encoder.make_direct_frame(colors, gamma), config.mem_block_symbols, bit_period);
+    benchmark_refill("linear_rgb16", encoder.make_direct_frame(linear_colors, linear), config.mem_block_symbols, bit_period);
+
+    // And on the wire: the colors must not change until the frame is done
+    ESP_ERROR_CHECK(encoder.transmit_direct(colors));
+    ESP_ERROR_CHECK(encoder.wait_all_done());
+
+    while (true) {
+        std::this_thread::sleep_for(1s);
+    }
+}
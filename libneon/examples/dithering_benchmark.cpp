@@ -0,0 +1,66 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <neo/extractor.hpp>
+#include <thread>
+
+static constexpr std::size_t strip_num_leds = 1000;
+static constexpr std::size_t num_frames = 256;
+
+using namespace std::chrono_literals;
+
+/**
+ * Extracts `num_frames` frames of `colors` via `extractor`, and logs the time per frame.
+ * If `sums` is not empty, each extracted byte is also added to the corresponding entry.
+ */
+template <class Extractor>
+void benchmark_extract(const char *name, Extractor const &extractor, std::vector<neo::linear_rgb16> const &colors,
+                       std::vector<std::uint8_t> &bytes, std::vector<std::uint32_t> &sums) {
+    constexpr auto sequence = neo::static_channel_sequence<neo::channel::g, neo::channel::r, neo::channel::b>{};
+    std::int64_t total_us = 0;
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        const std::int64_t start = esp_timer_get_time();
+        neo::extractor_begin_frame(extractor, bytes.size());
+        sequence.extract(std::begin(colors), std::end(colors), std::begin(bytes), extractor);
+        total_us += esp_timer_get_time() - start;
+        for (std::size_t j = 0; j < sums.size(); ++j) {
+            sums[j] += bytes[j];
+        }
+    }
+    ESP_LOGI("NEO", "%s, %d LEDs: %lld us/frame.", name, int(colors.size()), (long long) (total_us / std::int64_t(num_frames)));
+}
+
+extern "C" [[noreturn]] void app_main() {
+    // A dim ramp, where 8 bits collapse to a few levels
+    std::vector<neo::linear_rgb16> colors{strip_num_leds};
+    for (std::size_t i = 0; i < strip_num_leds; ++i) {
+        colors[i] = neo::linear_rgb16{std::uint16_t(i * 4), std::uint16_t(i * 2), std::uint16_t(i)};
+    }
+    std::vector<std::uint8_t> bytes(3 * strip_num_leds);
+    std::vector<std::uint32_t> sums(3 * strip_num_leds);
+    std::vector<std::uint32_t> no_sums{};
+
+    const neo::linear_gamma_channel_extractor base{};
+    const neo::dithering_channel_extractor dither{base};
+    benchmark_extract("linear_gamma_channel_extractor", base, colors, bytes, no_sums);
+    benchmark_extract("dithering_channel_extractor", dither, colors, bytes, sums);
+
+    // The average over n frames must be within 1/n of the 8.8 fixed point target, i.e. within 1 LSB of it in 8.8
+    std::uint32_t max_error = 0;
+    auto it = std::begin(sums);
+    for (neo::linear_rgb16 const &col : colors) {
+        for (neo::channel chn : {neo::channel::g, neo::channel::r, neo::channel::b}) {
+            const std::uint32_t target = base.extract_fixed(col, chn);
+            const std::uint32_t average = *(it++) * 0x100 / num_frames;
+            max_error = std::max(max_error, average > target ? average - target : target - average);
+        }
+    }
+    if (max_error * num_frames > 0x100) {
+        ESP_LOGE("NEO", "Dithering does not converge: the average is off by %d/256.", int(max_error));
+    } else {
+        ESP_LOGI("NEO", "Over %d frames, the average is within %d/256 of the target.", int(num_frames), int(max_error));
+    }
+
+    while (true) {
+        std::this_thread::sleep_for(1s);
+    }
+}
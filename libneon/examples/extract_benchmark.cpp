@@ -0,0 +1,51 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <neo/channel.hpp>
+#include <neo/color.hpp>
+#include <thread>
+
+static constexpr std::size_t num_rounds = 20;
+
+using namespace std::chrono_literals;
+
+/**
+ * Extracts `colors` into `bytes` via `sequence`, `num_rounds` times, and logs the time per frame and the throughput.
+ */
+template <class Sequence>
+void benchmark_extract(const char *name, Sequence const &sequence, std::vector<neo::srgb> const &colors, std::vector<std::uint8_t> &bytes) {
+    auto const &extractor = neo::srgb_linear_channel_extractor();
+    const std::int64_t start = esp_timer_get_time();
+    for (std::size_t i = 0; i < num_rounds; ++i) {
+        sequence.extract(std::begin(colors), std::end(colors), std::begin(bytes), extractor);
+    }
+    const std::int64_t elapsed = std::max(esp_timer_get_time() - start, std::int64_t(1));
+    ESP_LOGI("NEO", "%s, %d pixels: %lld us/frame, %lld kpixel/s.", name, int(colors.size()),
+             (long long) (elapsed / std::int64_t(num_rounds)), (long long) (std::int64_t(num_rounds * colors.size()) * 1000 / elapsed));
+}
+
+void benchmark_sizes(std::size_t num_leds) {
+    std::vector<neo::srgb> colors{num_leds};
+    for (std::size_t i = 0; i < num_leds; ++i) {
+        colors[i] = neo::srgb{std::uint8_t(i), std::uint8_t(3 * i), std::uint8_t(7 * i)};
+    }
+    std::vector<std::uint8_t> runtime_bytes(3 * num_leds);
+    std::vector<std::uint8_t> unrolled_bytes(3 * num_leds);
+
+    // The runtime sequence and the unrolled one that transmit picks for it
+    const neo::channel_sequence sequence{"grb"};
+    benchmark_extract("channel_sequence", sequence, colors, runtime_bytes);
+    sequence.dispatch([&](auto const &unrolled) { benchmark_extract("static_channel_sequence", unrolled, colors, unrolled_bytes); });
+
+    if (runtime_bytes != unrolled_bytes) {
+        ESP_LOGE("NEO", "The unrolled extraction does not match the runtime one!");
+    }
+}
+
+extern "C" [[noreturn]] void app_main() {
+    benchmark_sizes(1000);
+    benchmark_sizes(10000);
+
+    while (true) {
+        std::this_thread::sleep_for(1s);
+    }
+}
@@ -0,0 +1,49 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <neo/gradient.hpp>
+#include <thread>
+
+static constexpr std::size_t num_frames = 100;
+
+using namespace std::chrono_literals;
+using namespace neo::literals;
+
+/**
+ * Calls `render` with a different rotation for each of `num_frames` frames, and logs the time per frame.
+ */
+template <class Fn>
+void benchmark_frames(const char *name, std::size_t num_leds, Fn &&render) {
+    const std::int64_t start = esp_timer_get_time();
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        render(float(i) / float(num_frames));
+    }
+    const std::int64_t elapsed = esp_timer_get_time() - start;
+    ESP_LOGI("NEO", "%s, %d LEDs: %lld ns/frame.", name, int(num_leds), (long long) (elapsed * 1000 / std::int64_t(num_frames)));
+}
+
+extern "C" [[noreturn]] void app_main() {
+    // Complementary colors, where linear blending is muddy
+    const auto gradient = neo::gradient_make_uniform_from_colors({0xff0000_rgb, 0x00ffff_rgb, 0x0000ff_rgb, 0xffff00_rgb, 0xff0000_rgb});
+
+    // What gradient_fx does: bake once, then only sample the texture at every frame
+    neo::gradient_texture texture{};
+    const std::int64_t start = esp_timer_get_time();
+    texture.bake(gradient);
+    ESP_LOGI("NEO", "gradient_texture::bake: %lld us, once.", (long long) (esp_timer_get_time() - start));
+
+    for (std::size_t num_leds : {24, 900}) {
+        std::vector<neo::srgb> out{num_leds};
+        benchmark_frames("gradient_sample, blend_op::linear", num_leds, [&](float rotate) {
+            neo::gradient_sample(std::begin(gradient), std::end(gradient), num_leds, std::begin(out), rotate, 1.f, neo::blend_op::linear{});
+        });
+        benchmark_frames("gradient_sample, blend_op::oklab", num_leds, [&](float rotate) {
+            neo::gradient_sample(std::begin(gradient), std::end(gradient), num_leds, std::begin(out), rotate, 1.f, neo::blend_op::oklab{});
+        });
+        benchmark_frames("gradient_texture::sample", num_leds, [&](float rotate) { texture.sample(out, rotate); });
+        benchmark_frames("gradient_texture::sample, not interpolated", num_leds, [&](float rotate) { texture.sample(out, rotate, 1.f, false); });
+    }
+
+    while (true) {
+        std::this_thread::sleep_for(1s);
+    }
+}
@@ -0,0 +1,55 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <neo/color.hpp>
+#include <thread>
+
+static constexpr std::size_t hue_steps = 1024;
+static constexpr std::size_t sat_val_steps = 16;
+
+using namespace std::chrono_literals;
+
+extern "C" [[noreturn]] void app_main() {
+    // A grid over the whole HSV cylinder, converted once via hsv16 and once via the float hsv
+    std::vector<neo::hsv16> colors;
+    colors.reserve(hue_steps * (sat_val_steps + 1) * (sat_val_steps + 1));
+    for (std::size_t h = 0; h < hue_steps; ++h) {
+        for (std::size_t s = 0; s <= sat_val_steps; ++s) {
+            for (std::size_t v = 0; v <= sat_val_steps; ++v) {
+                colors.emplace_back(std::uint16_t(h * 0x10000 / hue_steps), std::uint16_t(s * 0xffff / sat_val_steps),
+                                    std::uint16_t(v * 0xffff / sat_val_steps));
+            }
+        }
+    }
+    std::vector<neo::srgb> actual{colors.size()};
+    std::vector<neo::srgb> expected{colors.size()};
+
+    std::int64_t start = esp_timer_get_time();
+    neo::convert_batch(colors, actual);
+    const std::int64_t batch_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (std::size_t i = 0; i < colors.size(); ++i) {
+        expected[i] = colors[i].to_hsv().to_rgb();
+    }
+    const std::int64_t float_us = esp_timer_get_time() - start;
+
+    ESP_LOGI("NEO", "%d colors: convert_batch %lld ns/pixel, hsv::to_rgb %lld ns/pixel.", int(colors.size()),
+             (long long) (batch_us * 1000 / std::int64_t(colors.size())), (long long) (float_us * 1000 / std::int64_t(colors.size())));
+
+    // hsv16 must be within 1 LSB of the float hsv, on every channel
+    int max_error = 0;
+    for (std::size_t i = 0; i < colors.size(); ++i) {
+        for (neo::channel chn : {neo::channel::r, neo::channel::g, neo::channel::b}) {
+            max_error = std::max(max_error, std::abs(int(actual[i][chn]) - int(expected[i][chn])));
+        }
+    }
+    if (max_error > 1) {
+        ESP_LOGE("NEO", "hsv16 differs from hsv by up to %d.", max_error);
+    } else {
+        ESP_LOGI("NEO", "hsv16 differs from hsv by at most %d.", max_error);
+    }
+
+    while (true) {
+        std::this_thread::sleep_for(1s);
+    }
+}
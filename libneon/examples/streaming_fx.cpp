@@ -0,0 +1,28 @@
+#include <neo/alarm.hpp>
+#include <neo/encoder.hpp>
+#include <neo/fx.hpp>
+
+static_assert(LIBNEON_DIRECT_TRANSMIT, "This example requires ESP-IDF 5.3 or later, without CONFIG_RMT_ISR_IRAM_SAFE.");
+
+static constexpr gpio_num_t strip_gpio_pin = GPIO_NUM_13;
+static constexpr std::size_t strip_num_leds = 4000;
+
+using namespace std::chrono_literals;
+using namespace neo::literals;
+
+extern "C" void app_main() {
+    // With DMA the RMT memory is larger, so the interrupt refills it less often
+    neo::led_encoder encoder{neo::encoding::ws2812b, neo::make_rmt_config(strip_gpio_pin, true, 1024)};
+
+    // Tile-safe, so it is rendered 64 LEDs at a time while the previous LEDs are on the wire
+    const auto fx = neo::wrap(neo::pulse_fx{
+            neo::hue_rotate_fx{5s, 8.f},
+            neo::gradient_fx{{0xff0000_rgb, 0x0000ff_rgb, 0xff0000_rgb}, 3s, 4.f},
+            2s});
+
+    // A frame of 4000 LEDs takes 120ms on the wire; only 4 chunks of 64 LEDs are held in memory
+    neo::alarm alarm{8_fps, fx->make_stream_callback(encoder, strip_num_leds, 64, 4)};
+    alarm.start();
+
+    vTaskSuspend(nullptr);
+}
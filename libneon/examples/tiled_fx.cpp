@@ -0,0 +1,27 @@
+#include <neo/alarm.hpp>
+#include <neo/encoder.hpp>
+#include <neo/executor.hpp>
+#include <neo/fx.hpp>
+
+static constexpr gpio_num_t strip_gpio_pin = GPIO_NUM_13;
+static constexpr std::size_t strip_num_leds = 1500;
+
+using namespace std::chrono_literals;
+using namespace neo::literals;
+
+extern "C" void app_main() {
+    neo::led_encoder encoder{neo::encoding::ws2812b, neo::make_rmt_config(strip_gpio_pin)};
+
+    // All tile-safe, so every frame is split between the two cores
+    const auto fx = neo::wrap(neo::blend_fx{
+            neo::hue_rotate_fx{5s, 4.f},
+            neo::pulse_fx{neo::solid_fx{0x0_rgb}, neo::gradient_fx{{0xff0000_rgb, 0x0000ff_rgb, 0xff0000_rgb}, 3s}, 2s},
+            0.5f});
+
+    // The alarm task renders on core 0, one worker on core 1
+    neo::thread_executor exec{1, 0};
+    neo::alarm alarm{30_fps, fx->make_tiled_callback(encoder, strip_num_leds, exec), 0};
+    alarm.start();
+
+    vTaskSuspend(nullptr);
+}
@@ -0,0 +1,48 @@
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <neo/alarm.hpp>
+#include <neo/fx.hpp>
+#include <thread>
+
+static constexpr std::size_t strip_num_leds = 300;
+static constexpr std::size_t num_frames = 1000;
+
+using namespace std::chrono_literals;
+using namespace neo::literals;
+
+extern "C" [[noreturn]] void app_main() {
+    const std::array<std::shared_ptr<neo::fx_base>, 4> all_fx = {
+            neo::wrap(neo::gradient_fx{{0xff0000_rgb, 0xffff00_rgb, 0x00ff00_rgb, 0x00ffff_rgb, 0x0000ff_rgb, 0xff00ff_rgb, 0xff0000_rgb}, 5s}),
+            neo::wrap(neo::gradient_fx{{{0.0, 0x0_rgb}, {0.1, 0x9999999_rgb}, {0.2, 0x444444_rgb}, {0.9, 0x0_rgb}}, 5s, 2.}),
+            neo::wrap(neo::pulse_fx{neo::solid_fx{0xff0000_rgb}, neo::solid_fx{0xffff00_rgb}, 2s}),
+            neo::wrap(neo::hue_rotate_fx{3s})};
+
+    auto fx_transition = std::make_shared<neo::transition_fx>();
+
+    // Only used as a clock, frames are rendered in this loop without transmitting
+    neo::alarm alarm{30_fps, [](neo::alarm &) {}};
+    alarm.start();
+
+    std::vector<neo::linear_rgb16> buffer{strip_num_leds};
+    neo::frame_arena arena{};
+    arena.reserve(fx_transition->scratch_depth() + 2, strip_num_leds);
+    const neo::frame_arena::scope scope{arena};
+
+    // Rapid fire: a new 2s transition at every frame, so that transitions never get to complete
+    std::int64_t total_us = 0;
+    std::int64_t worst_us = 0;
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        fx_transition->transition_to(alarm, all_fx[i % all_fx.size()], 2s);
+        const std::int64_t start = esp_timer_get_time();
+        fx_transition->populate_linear(alarm, buffer);
+        const std::int64_t elapsed = esp_timer_get_time() - start;
+        total_us += elapsed;
+        worst_us = std::max(worst_us, elapsed);
+    }
+    ESP_LOGI("NEO", "%d transitions over %d LEDs: %lld us/frame on average, %lld us at worst.",
+             int(num_frames), int(strip_num_leds), (long long) (total_us / std::int64_t(num_frames)), (long long) worst_us);
+
+    while (true) {
+        std::this_thread::sleep_for(1s);
+    }
+}
@@ -0,0 +1,29 @@
+#include <neo/alarm.hpp>
+#include <neo/encoder.hpp>
+#include <neo/fx.hpp>
+#include <neo/gradient.hpp>
+
+static constexpr gpio_num_t strip_gpio_pin = GPIO_NUM_13;
+static constexpr std::size_t strip_num_leds = 60;
+
+using namespace std::chrono_literals;
+using namespace neo::literals;
+
+extern "C" void app_main() {
+    neo::led_encoder encoder{neo::encoding::ws2812b, neo::make_rmt_config(strip_gpio_pin)};
+
+    const auto rainbow_fx = neo::wrap(neo::hue_rotate_fx{5s});
+    const auto spinner_fx = neo::wrap(neo::gradient_fx{{0x0_rgb, 0xffffff_rgb, 0x0_rgb}, 2s});
+
+    // A rainbow spreading from the center over the first 40 LEDs, a pulse and a spinner on the remaining 20
+    const auto zones_fx = neo::wrap(neo::zones_fx{{
+            {{0, 40}, rainbow_fx, true, true},
+            {{40, 50}, neo::wrap(neo::pulse_fx{neo::solid_fx{0x0_rgb}, neo::solid_fx{0x7fc0c2_rgb}, 4s})},
+            {{50, 60}, spinner_fx, true}}});
+
+    // One callback, one transmission per frame for the whole strip
+    neo::alarm alarm{30_fps, zones_fx->make_callback(encoder, strip_num_leds)};
+    alarm.start();
+
+    vTaskSuspend(nullptr);
+}
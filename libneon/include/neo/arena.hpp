@@ -0,0 +1,160 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_ARENA_HPP
+#define LIBNEON_ARENA_HPP
+
+#include <cassert>
+#include <deque>
+#include <neo/color.hpp>
+#include <ranges>
+#include <vector>
+
+namespace neo {
+
+    /**
+     * Scratch buffers for rendering a frame, borrowed with stack discipline: composite effects borrow a buffer, render
+     * their children into it (which may borrow more buffers), blend, and return it when the lease goes out of scope.
+     * Each nesting level has its own slot, which is reused across frames and only grows, so after the first frame no
+     * allocation happens. Growing a slot never moves the buffers of the other slots.
+     *
+     * Effects use @ref current, which @ref fx_base::make_callback sets via @ref scope for the duration of each frame.
+     * When no arena is installed, a fallback arena local to the calling thread is used.
+     */
+    class frame_arena {
+    public:
+        template <class T>
+        using range_t = std::ranges::subrange<typename std::vector<T>::iterator>;
+
+        template <class T>
+        class lease {
+            frame_arena &_arena;
+            range_t<T> _range;
+
+        public:
+            inline lease(frame_arena &arena, range_t<T> range);
+
+            lease(lease const &) = delete;
+            lease &operator=(lease const &) = delete;
+
+            [[nodiscard]] inline range_t<T> range() const;
+
+            inline ~lease();
+        };
+
+        /**
+         * Installs an arena as @ref current for the lifetime of the scope object, then restores the previous one.
+         */
+        class scope {
+            frame_arena *_previous;
+
+        public:
+            explicit scope(frame_arena &arena);
+
+            scope(scope const &) = delete;
+            scope &operator=(scope const &) = delete;
+
+            ~scope();
+        };
+
+        [[nodiscard]] static frame_arena &current();
+
+        /**
+         * Preallocates `depth` slots of `num_leds` elements each, both for @ref linear_rgb16 and for @ref srgb buffers,
+         * since any nesting level may borrow either.
+         */
+        void reserve(std::size_t depth, std::size_t num_leds);
+
+        /**
+         * Borrows a buffer of `n` elements. The content is unspecified.
+         * @note Leases must be released in reverse order, which is automatic as long as they are scoped variables.
+         */
+        template <class T>
+        [[nodiscard]] lease<T> borrow(std::size_t n);
+
+        /**
+         * @return The highest amount of bytes that was simultaneously borrowed.
+         */
+        [[nodiscard]] std::size_t peak_bytes() const;
+
+        /**
+         * @return The amount of bytes allocated by all slots.
+         */
+        [[nodiscard]] std::size_t reserved_bytes() const;
+
+    private:
+        template <class T>
+        struct stack {
+            std::deque<std::vector<T>> slots;
+            std::size_t depth = 0;
+        };
+
+        stack<linear_rgb16> _linear;
+        stack<srgb> _srgb;
+        std::size_t _used_bytes = 0;
+        std::size_t _peak_bytes = 0;
+
+        template <class T>
+        [[nodiscard]] stack<T> &stack_for();
+
+        template <class T>
+        void release(std::size_t n);
+
+        template <class T>
+        void reserve_stack(std::size_t depth, std::size_t num_leds);
+    };
+
+}// namespace neo
+
+namespace neo {
+
+    template <class T>
+    frame_arena::lease<T>::lease(frame_arena &arena, range_t<T> range) : _arena{arena}, _range{range} {}
+
+    template <class T>
+    frame_arena::range_t<T> frame_arena::lease<T>::range() const {
+        return _range;
+    }
+
+    template <class T>
+    frame_arena::lease<T>::~lease() {
+        _arena.release<T>(_range.size());
+    }
+
+    template <class T>
+    frame_arena::stack<T> &frame_arena::stack_for() {
+        static_assert(std::is_same_v<T, linear_rgb16> or std::is_same_v<T, srgb>, "Only srgb and linear_rgb16 buffers are supported.");
+        if constexpr (std::is_same_v<T, srgb>) {
+            return _srgb;
+        } else {
+            return _linear;
+        }
+    }
+
+    template <class T>
+    frame_arena::lease<T> frame_arena::borrow(std::size_t n) {
+        stack<T> &s = stack_for<T>();
+        if (s.depth == s.slots.size()) {
+            s.slots.emplace_back();
+        }
+        std::vector<T> &slot = s.slots[s.depth++];
+        if (slot.size() < n) {
+            slot.resize(n);
+        }
+        _used_bytes += n * sizeof(T);
+        _peak_bytes = std::max(_peak_bytes, _used_bytes);
+        return {*this, {std::begin(slot), std::next(std::begin(slot), std::ptrdiff_t(n))}};
+    }
+
+    template <class T>
+    void frame_arena::release(std::size_t n) {
+        stack<T> &s = stack_for<T>();
+        assert(s.depth > 0);
+        --s.depth;
+        _used_bytes -= n * sizeof(T);
+    }
+
+}// namespace neo
+
+#endif//LIBNEON_ARENA_HPP
@@ -0,0 +1,192 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_BLEND_HPP
+#define LIBNEON_BLEND_HPP
+
+#include <neo/color.hpp>
+#include <neo/math.hpp>
+#include <span>
+
+namespace neo {
+
+    /**
+     * Blend modes as functors, so that calls can be inlined. Each functor can be called as
+     * `srgb op(srgb l, srgb r, float t)`, with the same result as the corresponding `neo::blend_*` function.
+     * Functors which can do better than a pixel-by-pixel loop also provide a static `batch` method, which
+     * @ref blend_batch picks up automatically.
+     */
+    namespace blend_op {
+        struct lerp {
+            [[nodiscard]] inline srgb operator()(srgb l, srgb r, float t) const;
+        };
+
+        struct linear {
+            [[nodiscard]] inline srgb operator()(srgb l, srgb r, float t) const;
+        };
+
+        struct linear_lut {
+            [[nodiscard]] inline srgb operator()(srgb l, srgb r, float t) const;
+
+            static void batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t);
+        };
+
+        struct lerp_fixed {
+            [[nodiscard]] constexpr srgb operator()(srgb l, srgb r, float t) const;
+
+            /**
+             * SWAR kernel: processes the channels of several packed pixels at once, as many as fit in a machine word.
+             */
+            static void batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t);
+        };
+
+        struct round_down {
+            [[nodiscard]] constexpr srgb operator()(srgb l, srgb, float) const;
+
+            static void batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t);
+        };
+
+        struct round_up {
+            [[nodiscard]] constexpr srgb operator()(srgb, srgb r, float) const;
+
+            static void batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t);
+        };
+
+        struct nearest_neighbor {
+            [[nodiscard]] constexpr srgb operator()(srgb l, srgb r, float t) const;
+
+            /**
+             * @return True if `t` is (safely) less than 0.5, i.e. the left color is picked.
+             */
+            [[nodiscard]] static constexpr bool picks_left(float t);
+
+            static void batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t);
+        };
+    }// namespace blend_op
+
+    template <class BlendFn>
+    concept srgb_blend_fn = std::is_invocable_r_v<srgb, BlendFn const &, srgb, srgb, float>;
+
+    /**
+     * Blends `l` and `r` pixel by pixel with the constant factor `t`, and stores the result in `out`.
+     * Only the first `min(l.size(), r.size(), out.size())` pixels are processed. `out` may coincide with `l` or `r`.
+     * @return The number of pixels processed.
+     */
+    template <srgb_blend_fn BlendFn = blend_op::linear>
+    std::size_t blend_batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t, BlendFn const &blend_fn = {});
+
+    /**
+     * Counterpart of @ref blend_batch for @ref linear_rgb16 colors, which are always blended linearly.
+     */
+    std::size_t blend_batch(std::span<const linear_rgb16> l, std::span<const linear_rgb16> r, std::span<linear_rgb16> out, float t);
+
+    /**
+     * Same as @ref blend_batch with `l` filled with a constant color, whose contribution is computed only once.
+     */
+    std::size_t blend_batch(linear_rgb16 l, std::span<const linear_rgb16> r, std::span<linear_rgb16> out, float t);
+
+    /**
+     * Same as @ref blend_batch with `r` filled with a constant color, whose contribution is computed only once.
+     */
+    std::size_t blend_batch(std::span<const linear_rgb16> l, linear_rgb16 r, std::span<linear_rgb16> out, float t);
+
+    /**
+     * How a layer is combined with what lies below it, see @ref composite.
+     */
+    enum struct blend_mode : std::uint8_t {
+        normal,  ///< The layer replaces what is below.
+        add,     ///< Sum, saturated.
+        multiply,///< Product, darkens.
+        screen,  ///< Complement of the product of the complements, lightens.
+        max      ///< Maximum of each channel.
+    };
+
+    /**
+     * Combines `src` over `dst` with `mode`, then blends the result over `dst` with `weight` (see @ref unit_to_fixed),
+     * which accounts for opacity. All in linear space and integer arithmetic.
+     */
+    [[nodiscard]] constexpr linear_rgb16 composite(linear_rgb16 dst, linear_rgb16 src, blend_mode mode, std::uint32_t weight);
+
+}// namespace neo
+
+namespace neo {
+
+    srgb blend_op::lerp::operator()(srgb l, srgb r, float t) const {
+        return l.lerp(r, t);
+    }
+
+    srgb blend_op::linear::operator()(srgb l, srgb r, float t) const {
+        return l.blend(r, t);
+    }
+
+    srgb blend_op::linear_lut::operator()(srgb l, srgb r, float t) const {
+        return l.blend_fixed(r, unit_to_fixed(t));
+    }
+
+    constexpr srgb blend_op::lerp_fixed::operator()(srgb l, srgb r, float t) const {
+        return l.lerp_fixed(r, unit_to_fixed(t));
+    }
+
+    constexpr srgb blend_op::round_down::operator()(srgb l, srgb, float) const {
+        return l;
+    }
+
+    constexpr srgb blend_op::round_up::operator()(srgb, srgb r, float) const {
+        return r;
+    }
+
+    constexpr srgb blend_op::nearest_neighbor::operator()(srgb l, srgb r, float t) const {
+        return picks_left(t) ? l : r;
+    }
+
+    constexpr bool blend_op::nearest_neighbor::picks_left(float t) {
+        // Same as safe_less{}(t, 0.5f)
+        return std::abs(t - 0.5f) > std::numeric_limits<float>::epsilon() and t < 0.5f;
+    }
+
+    constexpr linear_rgb16 composite(linear_rgb16 dst, linear_rgb16 src, blend_mode mode, std::uint32_t weight) {
+        const auto screen = [](std::uint16_t d, std::uint16_t s) -> std::uint16_t {
+            return std::uint16_t(std::uint32_t(d) + s - mul_unit16(d, s));
+        };
+        const auto add = [](std::uint16_t d, std::uint16_t s) -> std::uint16_t {
+            return std::uint16_t(std::min<std::uint32_t>(std::uint32_t(d) + s, 0xffff));
+        };
+        switch (mode) {
+            case blend_mode::normal:
+                break;
+            case blend_mode::add:
+                src = {add(dst.r, src.r), add(dst.g, src.g), add(dst.b, src.b)};
+                break;
+            case blend_mode::multiply:
+                src = {mul_unit16(dst.r, src.r), mul_unit16(dst.g, src.g), mul_unit16(dst.b, src.b)};
+                break;
+            case blend_mode::screen:
+                src = {screen(dst.r, src.r), screen(dst.g, src.g), screen(dst.b, src.b)};
+                break;
+            case blend_mode::max:
+                src = {std::max(dst.r, src.r), std::max(dst.g, src.g), std::max(dst.b, src.b)};
+                break;
+        }
+        return dst.blend_fixed(src, weight);
+    }
+
+    template <srgb_blend_fn BlendFn>
+    std::size_t blend_batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t, BlendFn const &blend_fn) {
+        const std::size_t n = std::min({l.size(), r.size(), out.size()});
+        l = l.first(n);
+        r = r.first(n);
+        out = out.first(n);
+        if constexpr (requires { BlendFn::batch(l, r, out, t); }) {
+            BlendFn::batch(l, r, out, t);
+        } else {
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = blend_fn(l[i], r[i], t);
+            }
+        }
+        return n;
+    }
+
+}// namespace neo
+
+#endif//LIBNEON_BLEND_HPP
@@ -6,7 +6,9 @@
 #define LIBNEON_CHANNEL_HPP
 
 #include <bit>
+#include <iterator>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace neo {
@@ -21,11 +23,38 @@ namespace neo {
         b = 'b'
     };
 
+    /**
+     * @return 0, 1, 2 for @ref channel::r, @ref channel::g, @ref channel::b respectively.
+     */
+    [[nodiscard]] constexpr std::size_t channel_index(channel c);
+
     template <class Color>
     struct default_channel_extractor {
         [[nodiscard]] constexpr std::uint8_t operator()(Color col, channel chn) const;
     };
 
+    /**
+     * The only instance of @ref default_channel_extractor, for frames that refer to their extractor after returning.
+     */
+    template <class Color>
+    inline constexpr default_channel_extractor<Color> default_channel_extractor_v{};
+
+    /**
+     * Notifies a stateful extractor (e.g. @ref dithering_channel_extractor) that a new frame of `num_bytes` channel
+     * values is about to be extracted, by calling `extractor.begin_frame(num_bytes)` if it exists. Extractors wrapped
+     * in `std::reference_wrapper` are supported too. Does nothing for all other extractors.
+     */
+    template <class Extractor>
+    constexpr void extractor_begin_frame(Extractor const &extractor, std::size_t num_bytes);
+
+    /**
+     * An extractor that is notified of each frame via @ref extractor_begin_frame. Its output may change from frame to
+     * frame even if the colors do not (e.g. temporal dithering), so every frame must be transmitted.
+     */
+    template <class Extractor>
+    concept frame_stateful_extractor = requires(Extractor const &extractor, std::size_t num_bytes) { extractor.begin_frame(num_bytes); } or
+                                       requires(Extractor const &extractor, std::size_t num_bytes) { extractor.get().begin_frame(num_bytes); };
+
     struct channel_sequence {
         std::string_view sequence{};
 
@@ -53,17 +82,64 @@ namespace neo {
 
         template <class Color>
         [[nodiscard]] std::vector<std::uint8_t> extract(Color const &col) const;
+
+        /**
+         * Calls `fn` with the @ref static_channel_sequence equivalent to this sequence, if there is one (i.e. for any
+         * permutation of "rgb"), otherwise with `*this`. Use this to pick the unrolled extraction once per frame.
+         */
+        template <class Fn>
+        decltype(auto) dispatch(Fn &&fn) const;
+    };
+
+    /**
+     * Channel sequence known at compile time. Extraction is unrolled, with no per-byte loop or switch.
+     */
+    template <channel... Chns>
+    struct static_channel_sequence {
+        [[nodiscard]] static constexpr std::size_t size();
+
+        constexpr operator channel_sequence() const;
+
+        template <class Color, class OutputIterator, class Extractor = default_channel_extractor<Color>>
+        static OutputIterator extract(Color const &col, OutputIterator out, Extractor const &extractor = {});
+
+        template <class ColorIterator, class OutputIterator, class Extractor = default_channel_extractor<std::iter_value_t<ColorIterator>>>
+        static OutputIterator extract(ColorIterator begin, ColorIterator end, OutputIterator out, Extractor const &extractor = {});
+
+    private:
+        static constexpr char _sequence[] = {static_cast<char>(Chns)..., '\0'};
     };
 
 }// namespace neo
 
 namespace neo {
 
+    constexpr std::size_t channel_index(channel c) {
+        switch (c) {
+            case channel::r:
+                return 0;
+            case channel::g:
+                return 1;
+            case channel::b:
+                return 2;
+        }
+        return 0;
+    }
+
     template <class Color>
     constexpr std::uint8_t default_channel_extractor<Color>::operator()(Color col, channel chn) const {
         return col[chn];
     }
 
+    template <class Extractor>
+    constexpr void extractor_begin_frame(Extractor const &extractor, std::size_t num_bytes) {
+        if constexpr (requires { extractor.begin_frame(num_bytes); }) {
+            extractor.begin_frame(num_bytes);
+        } else if constexpr (requires { extractor.get().begin_frame(num_bytes); }) {
+            extractor.get().begin_frame(num_bytes);
+        }
+    }
+
     constexpr channel_sequence::channel_sequence(std::string_view seq) : sequence{seq} {}
 
     constexpr channel_sequence::channel_sequence(const char *seq) : sequence{seq} {}
@@ -77,7 +153,7 @@ namespace neo {
     }
 
     constexpr bool channel_sequence::operator!=(channel_sequence const &other) const {
-        return sequence == other.sequence;
+        return sequence != other.sequence;
     }
 
     constexpr auto channel_sequence::begin() const {
@@ -113,6 +189,51 @@ namespace neo {
         extract(col, std::back_inserter(retval));
         return retval;
     }
+
+    template <class Fn>
+    decltype(auto) channel_sequence::dispatch(Fn &&fn) const {
+        using enum channel;
+        if (*this == static_channel_sequence<g, r, b>{}) {
+            return std::forward<Fn>(fn)(static_channel_sequence<g, r, b>{});
+        } else if (*this == static_channel_sequence<r, g, b>{}) {
+            return std::forward<Fn>(fn)(static_channel_sequence<r, g, b>{});
+        } else if (*this == static_channel_sequence<r, b, g>{}) {
+            return std::forward<Fn>(fn)(static_channel_sequence<r, b, g>{});
+        } else if (*this == static_channel_sequence<g, b, r>{}) {
+            return std::forward<Fn>(fn)(static_channel_sequence<g, b, r>{});
+        } else if (*this == static_channel_sequence<b, r, g>{}) {
+            return std::forward<Fn>(fn)(static_channel_sequence<b, r, g>{});
+        } else if (*this == static_channel_sequence<b, g, r>{}) {
+            return std::forward<Fn>(fn)(static_channel_sequence<b, g, r>{});
+        }
+        return std::forward<Fn>(fn)(*this);
+    }
+
+    template <channel... Chns>
+    constexpr std::size_t static_channel_sequence<Chns...>::size() {
+        return sizeof...(Chns);
+    }
+
+    template <channel... Chns>
+    constexpr static_channel_sequence<Chns...>::operator channel_sequence() const {
+        return channel_sequence{std::string_view{_sequence, sizeof...(Chns)}};
+    }
+
+    template <channel... Chns>
+    template <class Color, class OutputIterator, class Extractor>
+    OutputIterator static_channel_sequence<Chns...>::extract(Color const &col, OutputIterator out, Extractor const &extractor) {
+        ((*(out++) = extractor(col, Chns)), ...);
+        return out;
+    }
+
+    template <channel... Chns>
+    template <class ColorIterator, class OutputIterator, class Extractor>
+    OutputIterator static_channel_sequence<Chns...>::extract(ColorIterator begin, ColorIterator end, OutputIterator out, Extractor const &extractor) {
+        for (auto it = begin; it != end; ++it) {
+            out = extract(*it, out, extractor);
+        }
+        return out;
+    }
 }// namespace neo
 
 #endif//LIBNEON_CHANNEL_HPP
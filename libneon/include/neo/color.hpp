@@ -8,10 +8,13 @@
 #include <array>
 #include <neo/channel.hpp>
 #include <neo/math.hpp>
+#include <span>
 
 namespace neo {
     struct srgb;
     struct hsv;
+    struct hsv16;
+    struct linear_rgb16;
 
     namespace literals {
         constexpr srgb operator""_rgb(unsigned long long int);
@@ -34,6 +37,20 @@ namespace neo {
         [[nodiscard]] srgb blend(srgb target, float factor) const;
         [[nodiscard]] srgb lerp(srgb target, float factor) const;
 
+        /**
+         * Same as @ref blend, but uses @ref srgb_linear_table and integer arithmetic instead of `std::pow`.
+         * The result matches @ref blend within ±1 on each channel.
+         * @param weight Fixed point blend factor, see @ref unit_to_fixed.
+         */
+        [[nodiscard]] srgb blend_fixed(srgb target, std::uint32_t weight) const;
+
+        /**
+         * Same as @ref lerp, but with integer arithmetic. The weight is reduced to 8 bits, so that the operation
+         * can be performed on several packed channels at once (see @ref blend_op::lerp_fixed).
+         * @param weight Fixed point blend factor, see @ref unit_to_fixed.
+         */
+        [[nodiscard]] constexpr srgb lerp_fixed(srgb target, std::uint32_t weight) const;
+
         [[nodiscard]] hsv to_hsv() const;
 
         [[nodiscard]] constexpr static float to_linear(std::uint8_t v);
@@ -45,6 +62,8 @@ namespace neo {
         [[nodiscard]] std::string to_string() const;
 
         [[nodiscard]] constexpr std::uint8_t operator[](channel c) const;
+
+        constexpr bool operator==(srgb const &other) const = default;
     };
 
     struct srgb_gamma_channel_extractor {
@@ -56,9 +75,122 @@ namespace neo {
     };
 
     /**
-     * @todo Deprecate when it can become constexpr (need constexpr std::pow)
+     * Built at compile time, see @ref srgb_gamma_extractor_v.
+     */
+    [[nodiscard]] constexpr srgb_gamma_channel_extractor const &srgb_linear_channel_extractor();
+
+    /**
+     * Lookup tables that convert sRGB channel values to linear space and back without `std::pow`.
+     * Linear values are represented in fixed point, in the range 0...0xffff.
+     */
+    struct srgb_linear_lut {
+        std::array<std::uint16_t, 0x100> to_linear;
+        /**
+         * `thresholds[i]` is the smallest linear value that is converted to the sRGB value `i`.
+         */
+        std::array<std::uint16_t, 0x100> thresholds;
+        /**
+         * sRGB value for the linear values `16 * i`. Buckets are narrower than the distance between any two
+         * thresholds, so each bucket spans at most two sRGB values.
+         */
+        std::array<std::uint8_t, 0x1000> coarse;
+
+        constexpr srgb_linear_lut();
+
+        /**
+         * Inverse of @ref to_linear; one lookup in @ref coarse, corrected with at most one comparison.
+         */
+        [[nodiscard]] constexpr std::uint8_t from_linear(std::uint16_t v) const;
+
+        /**
+         * Implementation of @ref srgb::blend_fixed.
+         */
+        [[nodiscard]] constexpr srgb blend(srgb l, srgb r, std::uint32_t weight) const;
+    };
+
+    /**
+     * Built at compile time, see @ref srgb_linear_lut_v.
+     */
+    [[nodiscard]] constexpr srgb_linear_lut const &srgb_linear_table();
+
+    /**
+     * Linear RGB, 16 bits per channel (0...0xffff).
+     * Effects use this as working space, so that colors are converted from and to sRGB only once per frame,
+     * and no precision is lost between stages.
+     */
+    struct linear_rgb16 {
+        std::uint16_t r = 0;
+        std::uint16_t g = 0;
+        std::uint16_t b = 0;
+
+        constexpr linear_rgb16() = default;
+
+        constexpr linear_rgb16(std::uint16_t r_, std::uint16_t g_, std::uint16_t b_);
+
+        /**
+         * Converts via @ref srgb_linear_table.
+         */
+        explicit inline linear_rgb16(srgb rgb);
+
+        /**
+         * Converts via @ref srgb_linear_table.
+         */
+        [[nodiscard]] inline srgb to_srgb() const;
+
+        /**
+         * Linear interpolation, which in linear space is the same as @ref srgb::blend.
+         */
+        [[nodiscard]] constexpr linear_rgb16 blend(linear_rgb16 target, float factor) const;
+
+        /**
+         * @param weight Fixed point blend factor, see @ref unit_to_fixed.
+         */
+        [[nodiscard]] constexpr linear_rgb16 blend_fixed(linear_rgb16 target, std::uint32_t weight) const;
+
+        [[nodiscard]] constexpr std::uint16_t operator[](channel c) const;
+
+        /**
+         * Relative luminance with Rec. 709 weights, in the range 0...0xffff.
+         */
+        [[nodiscard]] constexpr std::uint16_t luminance() const;
+
+        constexpr bool operator==(linear_rgb16 const &other) const = default;
+    };
+
+    /**
+     * Rounds to 8 bits, without any gamma correction.
+     */
+    template <>
+    struct default_channel_extractor<linear_rgb16> {
+        [[nodiscard]] constexpr std::uint8_t operator()(linear_rgb16 col, channel chn) const;
+    };
+
+    /**
+     * Channel extractor for @ref linear_rgb16 colors, counterpart of @ref srgb_gamma_channel_extractor.
+     * Computes `pow(v, gamma)` by linear interpolation over 257 knots.
+     */
+    struct linear_gamma_channel_extractor {
+        /**
+         * `lut[i]` is `pow(i / 256, gamma)` in 8.8 fixed point, i.e. in the range 0...0xff00.
+         */
+        std::array<std::uint16_t, 0x101> lut;
+
+        constexpr explicit linear_gamma_channel_extractor(float gamma = 1.f);
+
+        /**
+         * @return The gamma corrected channel value, in 8.8 fixed point.
+         */
+        [[nodiscard]] constexpr std::uint16_t extract_fixed(std::uint16_t v) const;
+
+        [[nodiscard]] constexpr std::uint16_t extract_fixed(linear_rgb16 col, channel chn) const;
+
+        [[nodiscard]] constexpr std::uint8_t operator()(linear_rgb16 col, channel chn) const;
+    };
+
+    /**
+     * Built at compile time, see @ref linear_gamma_extractor_v.
      */
-    [[nodiscard]] srgb_gamma_channel_extractor const &srgb_linear_channel_extractor();
+    [[nodiscard]] constexpr linear_gamma_channel_extractor const &linear_channel_extractor();
 
     struct hsv {
         float h = 0.f;
@@ -74,17 +206,69 @@ namespace neo {
         [[nodiscard]] srgb to_rgb() const;
     };
 
+    /**
+     * Integer counterpart of @ref hsv, over linear light like @ref linear_rgb16.
+     * The hue covers a full turn in 0...0xffff (so it wraps around on overflow); saturation and value are in the range
+     * 0...0xffff. Converts without floating point arithmetic, via @ref hue_wheel.
+     */
+    struct hsv16 {
+        std::uint16_t h = 0;
+        std::uint16_t s = 0;
+        std::uint16_t v = 0;
+
+        constexpr hsv16() = default;
+
+        constexpr hsv16(std::uint16_t h_, std::uint16_t s_, std::uint16_t v_);
+
+        constexpr explicit hsv16(hsv const &hsv_);
+
+        [[nodiscard]] constexpr hsv to_hsv() const;
+
+        [[nodiscard]] constexpr linear_rgb16 to_linear() const;
+
+        /**
+         * Converts via @ref srgb_linear_table.
+         */
+        [[nodiscard]] inline srgb to_rgb() const;
+
+        constexpr bool operator==(hsv16 const &other) const = default;
+    };
+
+    /**
+     * Fully saturated colors around the hue wheel, 64 knots for each of the 6 sectors, plus one to close the circle.
+     * In linear space the wheel is piecewise linear, so interpolating between the knots is exact.
+     */
+    struct hue_wheel_lut {
+        static constexpr std::size_t knots_per_sector = 64;
+        std::array<linear_rgb16, 6 * knots_per_sector + 1> knots;
+
+        constexpr hue_wheel_lut();
+
+        [[nodiscard]] constexpr linear_rgb16 sample(std::uint16_t h) const;
+    };
+
+    /**
+     * Converts `in` into `out`. Only the first `min(in.size(), out.size())` colors are processed.
+     * @return The number of colors processed.
+     */
+    std::size_t convert_batch(std::span<const hsv16> in, std::span<linear_rgb16> out);
+
+    /**
+     * @copydoc convert_batch(std::span<const hsv16>, std::span<linear_rgb16>)
+     */
+    std::size_t convert_batch(std::span<const hsv16> in, std::span<srgb> out);
+
 }// namespace neo
 
 namespace neo {
 
     constexpr float srgb::to_linear(std::uint8_t v) {
         const float f = byte_to_unit(v);
-        return f <= 0.04045f ? f / 12.92f : std::pow((f + 0.055f) / 1.055f, 2.4f);
+        return f <= 0.04045f ? f / 12.92f : constexpr_pow((f + 0.055f) / 1.055f, 2.4f);
     }
 
     constexpr std::uint8_t srgb::from_linear(float v) {
-        v = v <= 0.0031308f ? v * 12.92f : 1.055f * std::pow(v, 1.f / 2.4f) - 0.055f;
+        v = v <= 0.0031308f ? v * 12.92f : 1.055f * constexpr_pow(v, 1.f / 2.4f) - 0.055f;
         return unit_to_byte(v);
     }
 
@@ -101,7 +285,7 @@ namespace neo {
             if (gamma == 1.f) {
                 lut[val] = unit_to_byte(srgb::to_linear(std::uint8_t(val)));
             } else {
-                lut[val] = unit_to_byte(std::pow(srgb::to_linear(std::uint8_t(val)), gamma));
+                lut[val] = unit_to_byte(constexpr_pow(srgb::to_linear(std::uint8_t(val)), gamma));
             }
         }
     }
@@ -110,6 +294,42 @@ namespace neo {
         return lut[col[chn]];
     }
 
+    constexpr srgb_linear_lut::srgb_linear_lut() : to_linear{}, thresholds{}, coarse{} {
+        for (std::uint16_t val = 0x00; val <= 0xff; ++val) {
+            to_linear[val] = std::uint16_t(std::round(srgb::to_linear(std::uint8_t(val)) * 65535.f));
+            // Linear value that maps to val - 0.5, i.e. the rounding boundary between val - 1 and val
+            const double f = (double(val) - 0.5) / 255.;
+            const double lin = f <= 0.04045 ? f / 12.92 : constexpr_pow((f + 0.055) / 1.055, 2.4);
+            thresholds[val] = std::uint16_t(std::clamp(std::ceil(lin * 65535.), 0., 65535.));
+        }
+        std::uint8_t val = 0;
+        for (std::size_t i = 0; i < coarse.size(); ++i) {
+            while (val < 0xff and (i << 4) >= thresholds[val + 1]) {
+                ++val;
+            }
+            coarse[i] = val;
+        }
+    }
+
+    constexpr std::uint8_t srgb_linear_lut::from_linear(std::uint16_t v) const {
+        const std::uint8_t i = coarse[v >> 4];
+        return (i < 0xff and v >= thresholds[i + 1]) ? i + 1 : i;
+    }
+
+    constexpr srgb srgb_linear_lut::blend(srgb l, srgb r, std::uint32_t weight) const {
+        return {from_linear(lerp_fixed(to_linear[l.r], to_linear[r.r], weight)),
+                from_linear(lerp_fixed(to_linear[l.g], to_linear[r.g], weight)),
+                from_linear(lerp_fixed(to_linear[l.b], to_linear[r.b], weight))};
+    }
+
+    constexpr srgb srgb::lerp_fixed(srgb target, std::uint32_t weight) const {
+        const std::uint32_t w = (std::min(weight, 0x10000u) + 0x80) >> 8;
+        const auto lerp_chn = [&](std::uint8_t l, std::uint8_t r) -> std::uint8_t {
+            return std::uint8_t((std::uint32_t(l) * (0x100 - w) + std::uint32_t(r) * w + 0x80) >> 8);
+        };
+        return {lerp_chn(r, target.r), lerp_chn(g, target.g), lerp_chn(b, target.b)};
+    }
+
     constexpr srgb literals::operator""_rgb(unsigned long long int c) {
         return srgb{std::uint32_t(c)};
     }
@@ -136,6 +356,169 @@ namespace neo {
 
     constexpr hsv::hsv(float h_, float s_, float v_) : h{h_}, s{s_}, v{v_} {}
 
+    constexpr linear_rgb16::linear_rgb16(std::uint16_t r_, std::uint16_t g_, std::uint16_t b_)
+        : r{r_}, g{g_}, b{b_} {}
+
+    linear_rgb16::linear_rgb16(srgb rgb) {
+        auto const &lut = srgb_linear_table();
+        r = lut.to_linear[rgb.r];
+        g = lut.to_linear[rgb.g];
+        b = lut.to_linear[rgb.b];
+    }
+
+    srgb linear_rgb16::to_srgb() const {
+        auto const &lut = srgb_linear_table();
+        return {lut.from_linear(r), lut.from_linear(g), lut.from_linear(b)};
+    }
+
+    constexpr linear_rgb16 linear_rgb16::blend(linear_rgb16 target, float factor) const {
+        return blend_fixed(target, unit_to_fixed(factor));
+    }
+
+    constexpr linear_rgb16 linear_rgb16::blend_fixed(linear_rgb16 target, std::uint32_t weight) const {
+        return {lerp_fixed(r, target.r, weight), lerp_fixed(g, target.g, weight), lerp_fixed(b, target.b, weight)};
+    }
+
+    constexpr std::uint16_t linear_rgb16::operator[](channel c) const {
+        switch (c) {
+            case channel::r:
+                return r;
+            case channel::g:
+                return g;
+            case channel::b:
+                return b;
+        }
+        return 0;
+    }
+
+    constexpr std::uint16_t linear_rgb16::luminance() const {
+        // 0.2126, 0.7152, 0.0722 in 16.16 fixed point, adjusted to sum to exactly 0x10000
+        return std::uint16_t((13933u * r + 46871u * g + 4732u * b + 0x8000) >> 16);
+    }
+
+    constexpr std::uint8_t default_channel_extractor<linear_rgb16>::operator()(linear_rgb16 col, channel chn) const {
+        return std::uint8_t((std::uint32_t(col[chn]) * 0xff + 0x7fff) / 0xffff);
+    }
+
+    constexpr linear_gamma_channel_extractor::linear_gamma_channel_extractor(float gamma) : lut{} {
+        for (std::uint16_t i = 0; i < lut.size(); ++i) {
+            const float v = float(i) / 256.f;
+            lut[i] = std::uint16_t(std::round(std::clamp(gamma == 1.f ? v : constexpr_pow(v, gamma), 0.f, 1.f) * float(0xff00)));
+        }
+    }
+
+    constexpr std::uint16_t linear_gamma_channel_extractor::extract_fixed(std::uint16_t v) const {
+        const std::uint32_t lo = lut[v >> 8];
+        const std::uint32_t hi = lut[(v >> 8) + 1];
+        const std::uint32_t frac = v & 0xff;
+        return std::uint16_t((lo * (0x100 - frac) + hi * frac + 0x80) >> 8);
+    }
+
+    constexpr std::uint16_t linear_gamma_channel_extractor::extract_fixed(linear_rgb16 col, channel chn) const {
+        return extract_fixed(col[chn]);
+    }
+
+    constexpr std::uint8_t linear_gamma_channel_extractor::operator()(linear_rgb16 col, channel chn) const {
+        return std::uint8_t((extract_fixed(col[chn]) + 0x80) >> 8);
+    }
+
+    /**
+     * @ref srgb_gamma_channel_extractor for a given gamma, built at compile time (i.e. it is stored in flash, and needs
+     * no initialization at startup).
+     */
+    template <float Gamma>
+    inline constexpr srgb_gamma_channel_extractor srgb_gamma_extractor_v{Gamma};
+
+    /**
+     * @ref linear_gamma_channel_extractor for a given gamma, built at compile time.
+     */
+    template <float Gamma>
+    inline constexpr linear_gamma_channel_extractor linear_gamma_extractor_v{Gamma};
+
+    /**
+     * The only instance of @ref srgb_linear_lut, which is built at compile time.
+     */
+    inline constexpr srgb_linear_lut srgb_linear_lut_v{};
+
+    constexpr srgb_gamma_channel_extractor const &srgb_linear_channel_extractor() {
+        return srgb_gamma_extractor_v<1.f>;
+    }
+
+    constexpr srgb_linear_lut const &srgb_linear_table() {
+        return srgb_linear_lut_v;
+    }
+
+    constexpr linear_gamma_channel_extractor const &linear_channel_extractor() {
+        return linear_gamma_extractor_v<1.f>;
+    }
+
+    constexpr hue_wheel_lut::hue_wheel_lut() : knots{} {
+        for (std::size_t i = 0; i < knots.size(); ++i) {
+            const std::size_t sector = (i / knots_per_sector) % 6;
+            const auto rising = std::uint16_t((0xffff * (i % knots_per_sector) + knots_per_sector / 2) / knots_per_sector);
+            const auto falling = std::uint16_t(0xffff - rising);
+            switch (sector) {
+                case 0:
+                    knots[i] = {0xffff, rising, 0};
+                    break;
+                case 1:
+                    knots[i] = {falling, 0xffff, 0};
+                    break;
+                case 2:
+                    knots[i] = {0, 0xffff, rising};
+                    break;
+                case 3:
+                    knots[i] = {0, falling, 0xffff};
+                    break;
+                case 4:
+                    knots[i] = {rising, 0, 0xffff};
+                    break;
+                default:
+                    knots[i] = {0xffff, 0, falling};
+                    break;
+            }
+        }
+    }
+
+    constexpr linear_rgb16 hue_wheel_lut::sample(std::uint16_t h) const {
+        const std::uint32_t pos = std::uint32_t(h) * (knots.size() - 1);
+        const std::size_t i = pos >> 16;
+        // 16.16 fractional part, reduced to a lerp_fixed weight
+        const std::uint32_t weight = pos & 0xffff;
+        return {lerp_fixed(knots[i].r, knots[i + 1].r, weight),
+                lerp_fixed(knots[i].g, knots[i + 1].g, weight),
+                lerp_fixed(knots[i].b, knots[i + 1].b, weight)};
+    }
+
+    /**
+     * The only instance of @ref hue_wheel_lut, which is built at compile time.
+     */
+    inline constexpr hue_wheel_lut hue_wheel{};
+
+    constexpr hsv16::hsv16(std::uint16_t h_, std::uint16_t s_, std::uint16_t v_) : h{h_}, s{s_}, v{v_} {}
+
+    constexpr hsv16::hsv16(hsv const &hsv_)
+        : h{std::uint16_t(std::uint32_t(std::round(modclamp(hsv_.h) * 65536.f)))},
+          s{unit_to_u16(hsv_.s)},
+          v{unit_to_u16(hsv_.v)} {}
+
+    constexpr hsv hsv16::to_hsv() const {
+        return {float(h) / 65536.f, float(s) / 65535.f, float(v) / 65535.f};
+    }
+
+    constexpr linear_rgb16 hsv16::to_linear() const {
+        // Each channel is v * (1 - s * (1 - w)), where w is the fully saturated wheel
+        const linear_rgb16 w = hue_wheel.sample(h);
+        const std::uint16_t vs = mul_unit16(v, s);
+        return {std::uint16_t(v - mul_unit16(vs, 0xffff - w.r)),
+                std::uint16_t(v - mul_unit16(vs, 0xffff - w.g)),
+                std::uint16_t(v - mul_unit16(vs, 0xffff - w.b))};
+    }
+
+    srgb hsv16::to_rgb() const {
+        return to_linear().to_srgb();
+    }
+
 }// namespace neo
 
 #endif//NEO_COLOR_HPP
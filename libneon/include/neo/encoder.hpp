@@ -5,15 +5,38 @@
 #ifndef LIBNEON_ENCODER_HPP
 #define LIBNEON_ENCODER_HPP
 
+#include <array>
+#include <atomic>
+#include <cassert>
 #include <chrono>
 #include <cstdint>
 #include <driver/gpio.h>
 #include <driver/rmt_tx.h>
 #include <driver/rmt_types.h>
+#include <esp_idf_version.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <limits>
+#include <memory>
 #include <neo/channel.hpp>
+#include <neo/tracked_buffer.hpp>
+#include <optional>
 #include <ranges>
+#include <sdkconfig.h>
+#include <span>
 #include <vector>
 
+/**
+ * 1 if @ref neo::led_encoder::transmit_direct and @ref neo::led_encoder::transmit_stream are available. They need the
+ * simple encoders of the RMT driver, which were added in ESP-IDF 5.3. They are also unavailable with
+ * `CONFIG_RMT_ISR_IRAM_SAFE`: the interrupt calls @ref neo::direct_frame::fill_leds, a template, and GCC ignores
+ * `IRAM_ATTR` on template instantiations, so it would run from flash while the cache is disabled.
+ */
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0) and not defined(CONFIG_RMT_ISR_IRAM_SAFE)
+#define LIBNEON_DIRECT_TRANSMIT 1
+#else
+#define LIBNEON_DIRECT_TRANSMIT 0
+#endif
 
 namespace neo {
     using namespace std::chrono_literals;
@@ -52,13 +75,261 @@ namespace neo {
         static constexpr encoding_spec ws2811{500ns, 1200ns, 2000ns, 1300ns, 50us, "rgb"};
     };
 
+    /**
+     * Current draw model of a strip, used by @ref led_encoder to cap the total current.
+     * The estimated draw of a frame is `idle_ma_per_led * num_leds + sum(ma_per_step[chn] * value)` over all the
+     * extracted channel values.
+     */
+    struct power_budget {
+        /**
+         * Current drawn by each step of red, green and blue (indexed by @ref channel_index), in mA.
+         * The defaults are for a WS2812B, which draws about 20mA per channel at full brightness.
+         */
+        std::array<float, 3> ma_per_step = {20.f / 255.f, 20.f / 255.f, 20.f / 255.f};
+        float idle_ma_per_led = 1.f;
+        /**
+         * Maximum current that the power supply can deliver to the strip, in mA.
+         */
+        float budget_ma = std::numeric_limits<float>::infinity();
+    };
+
+    /**
+     * Statistics of the last frame sent by @ref led_encoder::transmit with a @ref power_budget.
+     */
+    struct frame_stats {
+        std::size_t num_leds = 0;
+        /**
+         * Estimated draw of the frame as rendered, in mA.
+         */
+        float estimated_ma = 0.f;
+        /**
+         * Scale factor applied to all channel values to stay within the budget; 1 if no limiting was needed.
+         */
+        float scale = 1.f;
+        /**
+         * Estimated draw of the frame as transmitted, in mA.
+         */
+        float limited_ma = 0.f;
+    };
+
+    /**
+     * Counters of the symbol cache of @ref led_encoder, see @ref led_encoder::set_symbol_cache.
+     */
+    struct symbol_cache_stats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t num_entries = 0;
+        /**
+         * Memory held by the cached frames, in bytes; never more than the cap.
+         */
+        std::size_t used_bytes = 0;
+    };
+
+    /**
+     * Called from the RMT interrupt when the transmission of `frame` (see @ref led_encoder::last_frame) is done.
+     * Must be short and ISR-safe, and placed in IRAM if `CONFIG_RMT_ISR_IRAM_SAFE` is set.
+     * @return True if a higher priority task has been woken up.
+     */
+    using transmit_done_fn = bool (*)(std::uint32_t frame, void *user_ctx);
+
+    /**
+     * A frame sent by @ref led_encoder::transmit_direct. The colors are turned into RMT symbols directly by the RMT
+     * interrupt, a few LEDs at a time as the channel memory needs refilling, with no intermediate byte buffer.
+     */
+    struct direct_frame {
+        /**
+         * Writes the symbols of `num_leds` LEDs starting at `first_led`; instantiated for each color, extractor and
+         * channel sequence, so that the extraction is inlined.
+         */
+        using fill_fn = void (*)(direct_frame const &frame, std::size_t first_led, std::size_t num_leds, rmt_symbol_word_t *symbols);
+
+        void const *colors = nullptr;
+        std::size_t num_leds = 0;
+        void const *extractor = nullptr;
+        fill_fn fill = nullptr;
+        channel_sequence chn_seq = {};
+        rmt_symbol_word_t bit0 = {};
+        rmt_symbol_word_t bit1 = {};
+        rmt_symbol_word_t reset_sym = {};
+        bool msb_first = true;
+
+        [[nodiscard]] std::size_t symbols_per_led() const;
+
+        /**
+         * Writes as many whole LEDs as fit in `symbols_free`, starting after the first `symbols_written` symbols of the
+         * frame, followed by the reset symbol at the end. Same contract as the callback of `rmt_new_simple_encoder`.
+         * @return The number of symbols written.
+         */
+        std::size_t encode(std::size_t symbols_written, std::size_t symbols_free, rmt_symbol_word_t *symbols, bool &done) const;
+
+        /**
+         * Writes the 8 symbols of `v`.
+         */
+        inline void encode_byte(std::uint8_t v, rmt_symbol_word_t *symbols) const;
+
+        template <class Color, class Extractor, class ChannelSequence>
+        static void fill_leds(direct_frame const &frame, std::size_t first_led, std::size_t num_leds, rmt_symbol_word_t *symbols);
+
+    private:
+        /**
+         * Output iterator for @ref channel_sequence::extract that encodes each value as it is assigned.
+         */
+        struct symbol_writer {
+            direct_frame const *frame;
+            rmt_symbol_word_t *symbols;
+
+            symbol_writer &operator*() { return *this; }
+            symbol_writer &operator++(int) { return *this; }
+            symbol_writer &operator=(std::uint8_t v);
+        };
+    };
+
+    /**
+     * A frame sent by @ref led_encoder::transmit_stream while it is still being produced. The producer writes chunks of
+     * @ref chunk_leds colors in turn into a ring of @ref num_slots slots and publishes them; the RMT interrupt encodes
+     * each chunk when it needs it, then frees its slot. Memory is thus bounded by the ring rather than by the strip, and
+     * the first LEDs go out before the last ones are produced. Create it with @ref led_encoder::make_stream_frame.
+     */
+    struct stream_frame {
+        /**
+         * Encodes the colors of the ring; @ref direct_frame::colors is the first slot and @ref direct_frame::num_leds
+         * the length of the strip.
+         */
+        direct_frame format;
+        std::size_t chunk_leds = 0;
+        std::size_t num_slots = 0;
+        std::atomic<std::size_t> published_chunks = 0;
+        std::atomic<std::size_t> consumed_chunks = 0;
+        /**
+         * LEDs sent black, since their chunk was not published yet when the RMT needed them. Never reset.
+         */
+        std::atomic<std::size_t> underrun_leds = 0;
+        SemaphoreHandle_t consumed_sem = nullptr;
+
+        stream_frame();
+        stream_frame(stream_frame const &) = delete;
+        stream_frame &operator=(stream_frame const &) = delete;
+        ~stream_frame();
+
+        [[nodiscard]] std::size_t num_chunks() const;
+
+        /**
+         * Index in the ring of the first LED of `chunk`.
+         */
+        [[nodiscard]] std::size_t slot_offset(std::size_t chunk) const;
+
+        /**
+         * Blocks until the slot of `chunk` can be written, i.e. until the chunk @ref num_slots before it was encoded.
+         */
+        esp_err_t wait_slot(std::size_t chunk, std::chrono::milliseconds timeout = std::chrono::milliseconds::max());
+
+        /**
+         * Makes the next chunk available to the RMT interrupt.
+         */
+        void publish_chunk();
+
+        /**
+         * Starts a new frame. The previous transmission of this frame must be done.
+         */
+        void restart();
+
+        /**
+         * Same as @ref direct_frame::encode, and frees the slots of the chunks that have been fully encoded.
+         */
+        std::size_t encode(std::size_t symbols_written, std::size_t symbols_free, rmt_symbol_word_t *symbols, bool &done);
+    };
+
+    /**
+     * Encodes and transmits frames via RMT. Transmissions are asynchronous: @ref transmit returns as soon as the frame
+     * is queued, so that the next frame can be rendered while the previous one is on the wire.
+     * Frames are extracted in turn into one of several byte buffers. A buffer is owned by the caller from
+     * @ref acquire_buffer to @ref submit_buffer, then by the RMT driver until its transmission is done, and it is
+     * reused only after that, waiting if needed. With two buffers, one frame can be rendered while the other is
+     * transmitted; more buffers allow queueing more frames, up to the `trans_queue_depth` of the channel.
+     */
     class led_encoder : private rmt_encoder_t {
+        /**
+         * Completion state shared with the RMT interrupt, on the heap so that it does not move with the encoder.
+         */
+        struct tx_sync {
+            std::atomic<std::uint32_t> done_frames = 0;
+            SemaphoreHandle_t done_sem = nullptr;
+            transmit_done_fn on_done = nullptr;
+            void *on_done_ctx = nullptr;
+
+            tx_sync();
+            ~tx_sync();
+        };
+
+        /**
+         * A byte buffer and the frame last transmitted from it, which must be done before it is written again.
+         */
+        struct tx_buffer {
+            std::vector<std::uint8_t> bytes;
+            /**
+             * Read by the RMT interrupt instead of @ref bytes when transmitted via @ref transmit_direct.
+             */
+            direct_frame direct;
+            std::uint32_t frame = 0;
+        };
+
         rmt_encoder_handle_t _bytes_encoder;
         rmt_encoder_handle_t _tail_encoder;
+        rmt_encoder_handle_t _direct_encoder;
+        rmt_encoder_handle_t _stream_encoder;
+        /**
+         * Sends the symbols of @ref _cache as they are.
+         */
+        rmt_encoder_handle_t _symbols_encoder;
+        rmt_bytes_encoder_config_t _bits_cfg;
         rmt_symbol_word_t _reset_sym;
         channel_sequence _chn_seq;
         rmt_channel_handle_t _rmt_chn;
-        std::vector<std::uint8_t> _buffer;
+        std::vector<tx_buffer> _buffers;
+        /**
+         * Index in @ref _buffers of the buffer holding the last extracted frame.
+         */
+        std::size_t _last_buffer = 0;
+        std::uint32_t _submitted_frames = 0;
+        std::unique_ptr<tx_sync> _sync;
+        std::optional<power_budget> _budget;
+        frame_stats _stats;
+
+        /**
+         * A frame fully encoded into symbols, reset symbol included, for when the same bytes are sent again.
+         */
+        struct cached_frame {
+            std::uint32_t hash = 0;
+            std::vector<std::uint8_t> bytes;
+            std::vector<rmt_symbol_word_t> symbols;
+            /**
+             * Last frame transmitted from @ref symbols; also orders entries by last use. It must be done before the
+             * entry is evicted.
+             */
+            std::uint32_t frame = 0;
+
+            [[nodiscard]] std::size_t memory() const;
+        };
+
+        std::vector<cached_frame> _cache;
+        std::size_t _cache_cap = 0;
+        std::size_t _cache_hits = 0;
+        std::size_t _cache_misses = 0;
+        /**
+         * Hash of the last frame that was not in the cache. A frame is cached only if it misses twice in a row, so that
+         * animations do not cause an allocation and an encoding pass at every frame.
+         */
+        std::optional<std::uint32_t> _last_miss_hash;
+        /**
+         * The @ref tracked_buffer that the last buffer was fully extracted from, if it can be updated incrementally.
+         */
+        void const *_tracked_source = nullptr;
+
+        static bool _on_trans_done(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx);
+        static std::size_t _encode_direct(const void *data, std::size_t data_size, std::size_t symbols_written, std::size_t symbols_free,
+                                          rmt_symbol_word_t *symbols, bool *done, void *arg);
+        static std::size_t _encode_stream(const void *data, std::size_t data_size, std::size_t symbols_written, std::size_t symbols_free,
+                                          rmt_symbol_word_t *symbols, bool *done, void *arg);
 
         static std::size_t _encode(rmt_encoder_t *encoder, rmt_channel_handle_t tx_channel, const void *primary_data, std::size_t data_size, rmt_encode_state_t *ret_state);
         static esp_err_t _reset(rmt_encoder_t *encoder);
@@ -67,22 +338,252 @@ namespace neo {
         std::size_t encode(rmt_channel_handle_t tx_channel, const void *primary_data, std::size_t data_size, rmt_encode_state_t *ret_state);
         esp_err_t reset();
 
+        /**
+         * Blocks until the RMT driver does not use this encoder nor its buffers anymore. Does nothing without a channel.
+         */
+        void wait_idle();
+
+        /**
+         * Deletes the RMT channel and encoders, after @ref wait_idle.
+         */
+        void release();
+
+        /**
+         * Computes @ref _stats from the per-channel sums of the extracted values, and scales down `buffer` in one pass
+         * if the frame exceeds the budget.
+         */
+        void apply_budget(std::array<std::uint32_t, 3> const &channel_sums, std::size_t num_leds, std::span<std::uint8_t> buffer);
+
+        [[nodiscard]] std::size_t next_buffer() const;
+
+        /**
+         * Waits for the next buffer in turn, and makes it the last buffer.
+         */
+        [[nodiscard]] tx_buffer &acquire_next();
+
+        /**
+         * Queues `data` for `encoder`, and counts it as the next frame if successful.
+         */
+        esp_err_t queue(rmt_encoder_handle_t encoder, void const *data, std::size_t size);
+
+#if LIBNEON_DIRECT_TRANSMIT
+        /**
+         * Queues the @ref direct_frame of the last buffer.
+         */
+        esp_err_t submit_direct();
+#endif
+
+        /**
+         * Queues `data` from the symbol cache if it is there, otherwise through the bytes encoder, caching it if it
+         * was also the previous frame.
+         */
+        esp_err_t transmit_cached(const_byte_range data);
+
+        /**
+         * Evicts the least recently used entries of @ref _cache that are not being transmitted, until `num_bytes` more
+         * fit in @ref _cache_cap.
+         * @return False if there is not enough room anyway.
+         */
+        bool make_cache_room(std::size_t num_bytes);
+
     public:
+        static constexpr std::chrono::milliseconds wait_forever = std::chrono::milliseconds::max();
+
         led_encoder();
-        explicit led_encoder(encoding enc, rmt_tx_channel_config_t config);
+        /**
+         * @param num_buffers Number of frames that can be in flight or being extracted at the same time, at least 1.
+         */
+        explicit led_encoder(encoding enc, rmt_tx_channel_config_t config, std::size_t num_buffers = 2);
 
         led_encoder(led_encoder const &) = delete;
         led_encoder &operator=(led_encoder const &) = delete;
 
-        led_encoder(led_encoder &&) noexcept = default;
-        led_encoder &operator=(led_encoder &&) noexcept = default;
+        /**
+         * Waits for the transmissions in progress on `other`, which refer to its address. `other` is left as if
+         * default-constructed.
+         */
+        led_encoder(led_encoder &&other) noexcept;
 
+        /**
+         * Waits for the transmissions in progress on both encoders, then releases the resources of this encoder.
+         * `other` is left as if default-constructed.
+         */
+        led_encoder &operator=(led_encoder &&other) noexcept;
 
+
+        /**
+         * Queues `data` for transmission as-is.
+         * @note `data` is owned by the RMT driver until the transmission is done: it must not be modified nor freed
+         *  before @ref is_done returns true for @ref last_frame (e.g. after @ref wait_done).
+         */
         esp_err_t transmit_raw(const_byte_range data);
 
+        /**
+         * Waits until the next buffer in turn is not being transmitted anymore, and hands it over to the caller until
+         * @ref submit_buffer. The content of the buffer is unspecified, and a @ref tracked_buffer transmitted next is
+         * extracted in full.
+         * @return The buffer, resized to `num_bytes`.
+         */
+        [[nodiscard]] std::span<std::uint8_t> acquire_buffer(std::size_t num_bytes);
+
+        /**
+         * Queues the buffer returned by the last @ref acquire_buffer for transmission, and hands it over to the RMT
+         * driver until @ref is_done returns true for @ref last_frame.
+         */
+        esp_err_t submit_buffer();
+
+        /**
+         * Extracts the channel values of all colors in the range and transmits them.
+         * If a @ref power_budget is set, the current draw is estimated while extracting, and if it exceeds the budget,
+         * all values are scaled down before transmitting.
+         */
         template <class ColorIterator, class Extractor = default_channel_extractor<std::iter_value_t<ColorIterator>>>
         esp_err_t transmit(ColorIterator begin, ColorIterator end, Extractor const &extractor = {});
 
+        /**
+         * Same as the other overload, but re-extracts only the dirty spans of `colors` if the previous frame was
+         * transmitted from the same buffer, then clears them. Everything is extracted on the first frame, when a
+         * @ref power_budget is set (values are scaled in place), or for a @ref frame_stateful_extractor.
+         * @note Changing the extractor or its settings does not dirty `colors`; call @ref tracked_buffer::mark_all_dirty.
+         *  Each buffer should be transmitted by a single encoder, since transmitting clears the dirty spans.
+         */
+        template <class Color, class Extractor = default_channel_extractor<Color>>
+        esp_err_t transmit(tracked_buffer<Color> &colors, Extractor const &extractor = {});
+
+#if LIBNEON_DIRECT_TRANSMIT
+        /**
+         * Zero-copy version of @ref transmit: the RMT interrupt extracts the channel values and turns them into symbols
+         * as it goes, so no byte buffer is filled and the frame is not copied. Requires ESP-IDF 5.3 or later and no
+         * `CONFIG_RMT_ISR_IRAM_SAFE`, see @ref LIBNEON_DIRECT_TRANSMIT.
+         * @note `colors` and `extractor` are owned by the RMT driver until the transmission is done: they must not be
+         *  modified nor destroyed before @ref is_done returns true for @ref last_frame. Thus `extractor` cannot be a
+         *  temporary, nor a @ref frame_stateful_extractor, since the previous frame may still be using its state. The
+         *  extractor runs in the interrupt, so it must be quick. No @ref power_budget is applied.
+         */
+        template <std::ranges::contiguous_range Range, class Extractor>
+        esp_err_t transmit_direct(Range const &colors, Extractor const &extractor);
+
+        /**
+         * Same as the other overload, with @ref default_channel_extractor.
+         */
+        template <std::ranges::contiguous_range Range>
+        esp_err_t transmit_direct(Range const &colors);
+
+        template <std::ranges::contiguous_range Range, class Extractor>
+        esp_err_t transmit_direct(Range const &colors, Extractor const &&extractor) = delete;
+#endif
+
+        /**
+         * The frame that @ref transmit_direct would queue for `colors`, e.g. to measure how long refilling takes.
+         * Same as @ref transmit_direct, `extractor` must outlive the frame.
+         */
+        template <std::ranges::contiguous_range Range, class Extractor>
+        [[nodiscard]] direct_frame make_direct_frame(Range const &colors, Extractor const &extractor) const;
+
+        /**
+         * Same as the other overload, with @ref default_channel_extractor.
+         */
+        template <std::ranges::contiguous_range Range>
+        [[nodiscard]] direct_frame make_direct_frame(Range const &colors) const;
+
+        template <std::ranges::contiguous_range Range, class Extractor>
+        direct_frame make_direct_frame(Range const &colors, Extractor const &&extractor) const = delete;
+
+        /**
+         * Sets up a @ref stream_frame for `num_leds` LEDs that uses `ring` as slots of `chunk_leds` colors each.
+         * @param ring Storage for the slots; its size must be a multiple of `chunk_leds`. It and `extractor` must outlive
+         *  the frame, thus `extractor` cannot be a temporary.
+         */
+        template <class Color, class Extractor>
+        [[nodiscard]] std::unique_ptr<stream_frame> make_stream_frame(std::span<Color const> ring, std::size_t num_leds, std::size_t chunk_leds,
+                                                                      Extractor const &extractor) const;
+
+        /**
+         * Same as the other overload, with @ref default_channel_extractor.
+         */
+        template <class Color>
+        [[nodiscard]] std::unique_ptr<stream_frame> make_stream_frame(std::span<Color const> ring, std::size_t num_leds, std::size_t chunk_leds) const;
+
+        template <class Color, class Extractor>
+        std::unique_ptr<stream_frame> make_stream_frame(std::span<Color const> ring, std::size_t num_leds, std::size_t chunk_leds,
+                                                        Extractor const &&extractor) const = delete;
+
+        /**
+         * Queues `frame`, of which usually the first chunks have already been published. Keep producing and publishing
+         * the other chunks, waiting for their slots with @ref stream_frame::wait_slot: chunks that are not published in
+         * time are sent black, and counted in @ref stream_frame::underrun_leds.
+         * @note `frame` must not be destroyed nor restarted before @ref is_done returns true for @ref last_frame.
+         *  Requires ESP-IDF 5.3 or later and no `CONFIG_RMT_ISR_IRAM_SAFE`, see @ref LIBNEON_DIRECT_TRANSMIT.
+         */
+#if LIBNEON_DIRECT_TRANSMIT
+        esp_err_t transmit_stream(stream_frame &frame);
+#endif
+
+        /**
+         * Enables an opt-in cache of frames fully encoded into RMT symbols, holding at most `max_bytes`; 0 disables it.
+         * When the bytes of a frame sent through @ref transmit or @ref transmit_raw are the same as a cached one (e.g. a
+         * static scene, or a paused animation), the cached symbols are sent as they are, and the bytes are not encoded
+         * again. Frames are looked up by an FNV-1a hash, then compared. A frame is cached the second time it is sent with
+         * no other uncached frame in between; it takes 33 times its bytes, and when the cache is full, the least recently
+         * used frame is evicted.
+         * @note Waits for all the transmissions in progress. Frames sent via @ref transmit_direct or
+         *  @ref transmit_stream are not cached.
+         */
+        void set_symbol_cache(std::size_t max_bytes);
+
+        [[nodiscard]] symbol_cache_stats cache_stats() const;
+
+        /**
+         * Limits the current drawn by the frames sent through @ref transmit. Pass `std::nullopt` to disable the limiter.
+         * @note @ref transmit_raw is not affected.
+         */
+        void set_budget(std::optional<power_budget> budget);
+
+        [[nodiscard]] std::optional<power_budget> const &budget() const;
+
+        /**
+         * @note Only updated when a budget is set.
+         */
+        [[nodiscard]] frame_stats const &last_frame_stats() const;
+
+        [[nodiscard]] std::size_t num_buffers() const;
+
+        /**
+         * Number of the last frame queued by @ref transmit or @ref transmit_raw. Frames are numbered from 1, wrapping
+         * around; 0 means that nothing was transmitted yet.
+         */
+        [[nodiscard]] std::uint32_t last_frame() const;
+
+        /**
+         * @return True if the transmission of `frame`, and thus of all the frames before it, is done.
+         */
+        [[nodiscard]] bool is_done(std::uint32_t frame) const;
+
+        /**
+         * Blocks until @ref is_done returns true for `frame`.
+         * @return `ESP_ERR_TIMEOUT` if it did not happen within `timeout`.
+         */
+        esp_err_t wait_done(std::uint32_t frame, std::chrono::milliseconds timeout = wait_forever);
+
+        /**
+         * Fence: blocks until all the queued frames have been transmitted.
+         */
+        esp_err_t wait_all_done(std::chrono::milliseconds timeout = wait_forever);
+
+        /**
+         * Blocks until @ref acquire_buffer can return without waiting.
+         */
+        esp_err_t wait_free_buffer(std::chrono::milliseconds timeout = wait_forever);
+
+        /**
+         * Sets a function to call from the RMT interrupt after each frame is transmitted, or none if null.
+         * @note Set it when no transmission is in progress.
+         */
+        void set_on_transmit_done(transmit_done_fn fn, void *user_ctx = nullptr);
+
+        /**
+         * Waits for all the transmissions in progress, which may be reading buffers owned by the encoder.
+         */
         ~led_encoder();
     };
 
@@ -134,12 +635,145 @@ namespace neo {
     constexpr encoding::encoding(encoding_spec spec) : encoding{spec.t0h, spec.t0l, spec.t1h, spec.t1l, spec.chn_seq, spec.res} {}
 
 
+    void direct_frame::encode_byte(std::uint8_t v, rmt_symbol_word_t *symbols) const {
+        // Branchless select between the two symbols, this runs for every bit in the interrupt
+        const std::uint32_t diff = bit0.val ^ bit1.val;
+        for (unsigned i = 0; i < 8; ++i) {
+            const unsigned shift = msb_first ? 7 - i : i;
+            symbols[i].val = bit0.val ^ (diff & (0u - ((v >> shift) & 1u)));
+        }
+    }
+
+    inline direct_frame::symbol_writer &direct_frame::symbol_writer::operator=(std::uint8_t v) {
+        frame->encode_byte(v, symbols);
+        symbols += 8;
+        return *this;
+    }
+
+    template <class Color, class Extractor, class ChannelSequence>
+    void direct_frame::fill_leds(direct_frame const &frame, std::size_t first_led, std::size_t num_leds, rmt_symbol_word_t *symbols) {
+        auto const *colors = static_cast<Color const *>(frame.colors);
+        Extractor const &extractor = *static_cast<Extractor const *>(frame.extractor);
+        symbol_writer out{&frame, symbols};
+        for (std::size_t i = first_led; i < first_led + num_leds; ++i) {
+            if constexpr (std::is_same_v<ChannelSequence, channel_sequence>) {
+                out = frame.chn_seq.extract(colors[i], out, extractor);
+            } else {
+                out = ChannelSequence::extract(colors[i], out, extractor);
+            }
+        }
+    }
+
+    template <std::ranges::contiguous_range Range, class Extractor>
+    direct_frame led_encoder::make_direct_frame(Range const &colors, Extractor const &extractor) const {
+        using color_t = std::ranges::range_value_t<Range>;
+        return {.colors = std::ranges::data(colors),
+                .num_leds = std::ranges::size(colors),
+                .extractor = &extractor,
+                .fill = _chn_seq.dispatch([](auto const &seq) -> direct_frame::fill_fn {
+                    return &direct_frame::fill_leds<color_t, Extractor, std::remove_cvref_t<decltype(seq)>>;
+                }),
+                .chn_seq = _chn_seq,
+                .bit0 = _bits_cfg.bit0,
+                .bit1 = _bits_cfg.bit1,
+                .reset_sym = _reset_sym,
+                .msb_first = bool(_bits_cfg.flags.msb_first)};
+    }
+
+    template <class Color, class Extractor>
+    std::unique_ptr<stream_frame> led_encoder::make_stream_frame(std::span<Color const> ring, std::size_t num_leds, std::size_t chunk_leds,
+                                                                 Extractor const &extractor) const {
+        static_assert(not frame_stateful_extractor<Extractor>, "Frames are extracted in the RMT interrupt, a stateful extractor cannot be notified.");
+        assert(chunk_leds > 0 and ring.size() >= chunk_leds and ring.size() % chunk_leds == 0);
+        auto frame = std::make_unique<stream_frame>();
+        frame->format = make_direct_frame(ring, extractor);
+        frame->format.num_leds = num_leds;
+        frame->chunk_leds = chunk_leds;
+        frame->num_slots = ring.size() / chunk_leds;
+        return frame;
+    }
+
+    template <class Color>
+    std::unique_ptr<stream_frame> led_encoder::make_stream_frame(std::span<Color const> ring, std::size_t num_leds, std::size_t chunk_leds) const {
+        return make_stream_frame(ring, num_leds, chunk_leds, default_channel_extractor_v<Color>);
+    }
+
+    template <std::ranges::contiguous_range Range>
+    direct_frame led_encoder::make_direct_frame(Range const &colors) const {
+        return make_direct_frame(colors, default_channel_extractor_v<std::ranges::range_value_t<Range>>);
+    }
+
+#if LIBNEON_DIRECT_TRANSMIT
+    template <std::ranges::contiguous_range Range, class Extractor>
+    esp_err_t led_encoder::transmit_direct(Range const &colors, Extractor const &extractor) {
+        static_assert(not frame_stateful_extractor<Extractor>, "Frames are extracted in the RMT interrupt, a stateful extractor cannot be notified.");
+        tx_buffer &buffer = acquire_next();
+        buffer.direct = make_direct_frame(colors, extractor);
+        return submit_direct();
+    }
+
+    template <std::ranges::contiguous_range Range>
+    esp_err_t led_encoder::transmit_direct(Range const &colors) {
+        return transmit_direct(colors, default_channel_extractor_v<std::ranges::range_value_t<Range>>);
+    }
+#endif
+
     template <class ColorIterator, class Extractor>
     esp_err_t led_encoder::transmit(ColorIterator begin, ColorIterator end, Extractor const &extractor) {
-        _buffer.clear();
-        _buffer.reserve(std::distance(begin, end) * _chn_seq.size());
-        _chn_seq.extract(begin, end, std::back_inserter(_buffer), extractor);
-        return transmit_raw(_buffer);
+        const std::size_t num_leds = std::distance(begin, end);
+        const std::span<std::uint8_t> buffer = acquire_buffer(num_leds * _chn_seq.size());
+        extractor_begin_frame(extractor, buffer.size());
+        if (not _budget) {
+            // Select the unrolled extraction for the channel order once per frame, rather than once per byte
+            _chn_seq.dispatch([&](auto const &seq) {
+                seq.extract(begin, end, buffer.data(), extractor);
+            });
+        } else {
+            // Meter the draw in the same pass; with an unrolled sequence the channel index is a constant
+            std::array<std::uint32_t, 3> channel_sums{};
+            const auto metered_extractor = [&](auto const &col, channel chn) -> std::uint8_t {
+                const std::uint8_t v = extractor(col, chn);
+                channel_sums[channel_index(chn)] += v;
+                return v;
+            };
+            _chn_seq.dispatch([&](auto const &seq) {
+                seq.extract(begin, end, buffer.data(), metered_extractor);
+            });
+            apply_budget(channel_sums, num_leds, buffer);
+        }
+        return submit_buffer();
+    }
+
+    template <class Color, class Extractor>
+    esp_err_t led_encoder::transmit(tracked_buffer<Color> &colors, Extractor const &extractor) {
+        const std::size_t nchn = _chn_seq.size();
+        const bool incremental = not frame_stateful_extractor<Extractor> and not _budget and
+                                 _tracked_source == &colors and _buffers[_last_buffer].bytes.size() == colors.size() * nchn;
+        if (not incremental) {
+            const auto all = colors.colors();
+            const esp_err_t err = transmit(std::begin(all), std::end(all), extractor);
+            if (not frame_stateful_extractor<Extractor> and not _budget) {
+                _tracked_source = &colors;
+            }
+            colors.clear_dirty();
+            return err;
+        }
+        // Start from the previous frame, which may still be in flight, but is only read
+        std::vector<std::uint8_t> const &prev_bytes = _buffers[_last_buffer].bytes;
+        const std::span<std::uint8_t> buffer = acquire_buffer(colors.size() * nchn);
+        if (buffer.data() != prev_bytes.data()) {
+            std::copy(std::begin(prev_bytes), std::end(prev_bytes), std::begin(buffer));
+        }
+        _tracked_source = &colors;
+        const auto all = colors.colors();
+        _chn_seq.dispatch([&](auto const &seq) {
+            for (index_span const &span : colors.dirty_spans()) {
+                seq.extract(std::next(std::begin(all), std::ptrdiff_t(span.first)), std::next(std::begin(all), std::ptrdiff_t(span.last)),
+                            std::next(buffer.data(), std::ptrdiff_t(span.first * nchn)), extractor);
+            }
+        });
+        colors.clear_dirty();
+        return submit_buffer();
     }
 
 }// namespace neo
@@ -0,0 +1,101 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_EXECUTOR_HPP
+#define LIBNEON_EXECUTOR_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace neo {
+
+    /**
+     * Runs batches of independent jobs, possibly in parallel. Used by @ref fx_base::populate_tiled to render the tiles
+     * of a frame on several cores.
+     */
+    class executor {
+    public:
+        /**
+         * Maximum number of jobs that run at the same time.
+         */
+        [[nodiscard]] virtual std::size_t concurrency() const = 0;
+
+        /**
+         * Calls `job(i)` for each `i` in `[0, num_jobs)`, in any order and possibly from other threads, and returns when
+         * all calls have returned. Must be called from one thread at a time.
+         */
+        virtual void run(std::size_t num_jobs, std::function<void(std::size_t)> const &job) = 0;
+
+        virtual ~executor() = default;
+    };
+
+    /**
+     * Runs all jobs in the calling thread.
+     */
+    class inline_executor final : public executor {
+    public:
+        [[nodiscard]] std::size_t concurrency() const override;
+        void run(std::size_t num_jobs, std::function<void(std::size_t)> const &job) override;
+    };
+
+    /**
+     * Runs jobs on persistent `std::thread` workers, and on the calling thread, which takes part too. On ESP-IDF,
+     * `std::thread` is backed by pthreads, so the workers are FreeRTOS tasks; each one is pinned to a core via
+     * `esp_pthread_set_cfg`, starting from the core after `first_core`, so that the calling task (e.g. an @ref alarm
+     * pinned to `first_core`) and the workers end up on different cores. Elsewhere the workers are plain threads, and
+     * `first_core` is ignored.
+     */
+    class thread_executor final : public executor {
+    public:
+        /**
+         * Does not pin the workers to any core.
+         */
+        static constexpr int no_affinity = -1;
+
+        /**
+         * @param num_workers Number of threads besides the calling one; the default uses all the other cores.
+         * @param first_core Core of the calling task, or @ref no_affinity.
+         */
+        explicit thread_executor(std::size_t num_workers = default_num_workers(), int first_core = 0);
+
+        thread_executor(thread_executor const &) = delete;
+        thread_executor &operator=(thread_executor const &) = delete;
+
+        [[nodiscard]] std::size_t concurrency() const override;
+        void run(std::size_t num_jobs, std::function<void(std::size_t)> const &job) override;
+
+        [[nodiscard]] static std::size_t default_num_workers();
+
+        ~thread_executor() override;
+
+    private:
+        std::vector<std::thread> _workers;
+        std::mutex _mtx;
+        std::condition_variable _work_cv;
+        std::condition_variable _done_cv;
+        std::function<void(std::size_t)> const *_job = nullptr;
+        std::size_t _num_jobs = 0;
+        std::size_t _next_job = 0;
+        std::size_t _pending_jobs = 0;
+        /**
+         * Incremented at every batch, so that workers can tell a new batch from a spurious wakeup.
+         */
+        std::size_t _generation = 0;
+        bool _stop = false;
+
+        void worker_body();
+
+        /**
+         * Takes and runs jobs of the current batch until there are none left. `lock` must own @ref _mtx.
+         */
+        void drain(std::unique_lock<std::mutex> &lock);
+    };
+
+}// namespace neo
+
+#endif//LIBNEON_EXECUTOR_HPP
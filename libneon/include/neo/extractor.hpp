@@ -0,0 +1,198 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_EXTRACTOR_HPP
+#define LIBNEON_EXTRACTOR_HPP
+
+#include <array>
+#include <atomic>
+#include <concepts>
+#include <memory>
+#include <neo/channel.hpp>
+#include <neo/color.hpp>
+#include <vector>
+
+namespace neo {
+
+    /**
+     * Channel extractor with a separate lookup table per channel, which bakes in gamma, a per-channel correction factor
+     * (e.g. for white balance) and a master brightness. It accepts both @ref srgb and @ref linear_rgb16 colors, so it
+     * can be passed to @ref led_encoder::transmit as well as to @ref fx_base::make_callback.
+     *
+     * Dimming thus costs nothing per frame compared with @ref srgb_gamma_channel_extractor or
+     * @ref linear_gamma_channel_extractor. Gamma is evaluated only once, at construction; @ref set_brightness and
+     * @ref set_correction rescale the tables with integer arithmetic only. The tables are double buffered: the new
+     * tables are built aside and then swapped in, so the extractor can be updated from another task while a frame is
+     * being rendered, as long as it is not updated more than once per frame.
+     *
+     * @note The encoder and @ref fx_base::make_callback copy the extractor they are given; to change the brightness
+     *  of a running effect, keep the extractor alive and pass it as `std::cref(extractor)`.
+     */
+    class corrected_channel_extractor {
+    public:
+        /**
+         * @param gamma Same as in @ref linear_gamma_channel_extractor.
+         * @param correction Scale factors for red, green and blue, in the range 0...1.
+         * @param brightness Master brightness, in the range 0...1.
+         */
+        explicit corrected_channel_extractor(float gamma = 1.f, std::array<float, 3> correction = {1.f, 1.f, 1.f},
+                                             float brightness = 1.f);
+
+        corrected_channel_extractor(corrected_channel_extractor const &other);
+        corrected_channel_extractor &operator=(corrected_channel_extractor const &other);
+
+        [[nodiscard]] float brightness() const;
+        [[nodiscard]] std::array<float, 3> const &correction() const;
+
+        void set_brightness(float brightness);
+        void set_correction(std::array<float, 3> correction);
+
+        /**
+         * @return The corrected channel value, in 8.8 fixed point.
+         */
+        [[nodiscard]] inline std::uint16_t extract_fixed(linear_rgb16 col, channel chn) const;
+
+        [[nodiscard]] inline std::uint8_t operator()(linear_rgb16 col, channel chn) const;
+        [[nodiscard]] inline std::uint8_t operator()(srgb col, channel chn) const;
+
+    private:
+        struct tables {
+            /**
+             * Per-channel knots for @ref linear_rgb16, in 8.8 fixed point, as in @ref linear_gamma_channel_extractor.
+             */
+            std::array<std::array<std::uint16_t, 0x101>, 3> linear{};
+            std::array<std::array<std::uint8_t, 0x100>, 3> srgb{};
+        };
+
+        /**
+         * Uncorrected `pow(v, gamma)` in 8.8 fixed point, for linear knots and for sRGB values respectively.
+         */
+        std::array<std::uint16_t, 0x101> _gamma_linear{};
+        std::array<std::uint16_t, 0x100> _gamma_srgb{};
+
+        std::array<float, 3> _correction;
+        float _brightness;
+
+        std::array<tables, 2> _tables{};
+        std::atomic<std::uint8_t> _front = 0;
+
+        [[nodiscard]] inline tables const &front() const;
+
+        void rebuild();
+    };
+
+    /**
+     * An extractor that produces channel values in 8.8 fixed point, like @ref linear_gamma_channel_extractor and
+     * @ref corrected_channel_extractor.
+     */
+    template <class Extractor>
+    concept fixed_channel_extractor = requires(Extractor const &e, linear_rgb16 col, channel chn) {
+        { e.extract_fixed(col, chn) } -> std::convertible_to<std::uint16_t>;
+    };
+
+    /**
+     * Temporal dithering on top of a @ref fixed_channel_extractor. The fractional part of each extracted byte is
+     * carried over to the same byte of the next frame, so that the time-averaged output converges to the 8.8 fixed
+     * point value: on top of 8 bits per frame, the remaining bits are delivered over successive refreshes. This makes
+     * low brightness levels and slow fades much smoother, at a high enough refresh rate.
+     *
+     * The state is one byte per extracted channel value, in a buffer shared by all copies of the extractor. The buffer
+     * is laid out in transmission order, so one extractor must be used for one strip only.
+     * @ref begin_frame must be called before extracting each frame; @ref led_encoder::transmit does that automatically
+     * (see @ref extractor_begin_frame).
+     *
+     * The initial errors are spread over the strip, so that pixels with the same color do not flicker in sync.
+     */
+    template <fixed_channel_extractor Extractor = linear_gamma_channel_extractor>
+    class dithering_channel_extractor {
+        struct state {
+            Extractor base;
+            std::vector<std::uint8_t> errors{};
+            std::size_t cursor = 0;
+        };
+
+        std::shared_ptr<state> _state;
+
+    public:
+        explicit dithering_channel_extractor(Extractor base = Extractor{});
+
+        /**
+         * The wrapped extractor, shared by all copies, e.g. to call @ref corrected_channel_extractor::set_brightness.
+         */
+        [[nodiscard]] Extractor &base() const;
+
+        /**
+         * Rewinds to the first byte of the strip. If `num_bytes` changed, the accumulated errors are reset.
+         */
+        void begin_frame(std::size_t num_bytes) const;
+
+        /**
+         * @note This consumes one byte of state, so it must be called exactly once per channel, in transmission order.
+         */
+        [[nodiscard]] std::uint8_t operator()(linear_rgb16 col, channel chn) const;
+    };
+
+}// namespace neo
+
+namespace neo {
+
+    corrected_channel_extractor::tables const &corrected_channel_extractor::front() const {
+        return _tables[_front.load(std::memory_order_acquire)];
+    }
+
+    std::uint16_t corrected_channel_extractor::extract_fixed(linear_rgb16 col, channel chn) const {
+        auto const &lut = front().linear[channel_index(chn)];
+        const std::uint16_t v = col[chn];
+        const std::uint32_t lo = lut[v >> 8];
+        const std::uint32_t hi = lut[(v >> 8) + 1];
+        const std::uint32_t frac = v & 0xff;
+        return std::uint16_t((lo * (0x100 - frac) + hi * frac + 0x80) >> 8);
+    }
+
+    std::uint8_t corrected_channel_extractor::operator()(linear_rgb16 col, channel chn) const {
+        return std::uint8_t((extract_fixed(col, chn) + 0x80) >> 8);
+    }
+
+    std::uint8_t corrected_channel_extractor::operator()(srgb col, channel chn) const {
+        return front().srgb[channel_index(chn)][col[chn]];
+    }
+
+    template <fixed_channel_extractor Extractor>
+    dithering_channel_extractor<Extractor>::dithering_channel_extractor(Extractor base)
+        : _state{std::make_shared<state>(state{std::move(base)})} {}
+
+    template <fixed_channel_extractor Extractor>
+    Extractor &dithering_channel_extractor<Extractor>::base() const {
+        return _state->base;
+    }
+
+    template <fixed_channel_extractor Extractor>
+    void dithering_channel_extractor<Extractor>::begin_frame(std::size_t num_bytes) const {
+        state &s = *_state;
+        if (s.errors.size() != num_bytes) {
+            s.errors.resize(num_bytes);
+            // Multiplying by ~256 / golden ratio scatters the initial phases evenly
+            for (std::size_t i = 0; i < num_bytes; ++i) {
+                s.errors[i] = std::uint8_t(i * 0x9e);
+            }
+        }
+        s.cursor = 0;
+    }
+
+    template <fixed_channel_extractor Extractor>
+    std::uint8_t dithering_channel_extractor<Extractor>::operator()(linear_rgb16 col, channel chn) const {
+        state &s = *_state;
+        const std::uint32_t v = s.base.extract_fixed(col, chn);
+        if (s.cursor >= s.errors.size()) {
+            // begin_frame was not called, or the frame is longer than announced: just round
+            return std::uint8_t(std::min<std::uint32_t>((v + 0x80) >> 8, 0xff));
+        }
+        const std::uint32_t acc = v + s.errors[s.cursor];
+        s.errors[s.cursor++] = std::uint8_t(acc);
+        return std::uint8_t(std::min<std::uint32_t>(acc >> 8, 0xff));
+    }
+
+}// namespace neo
+
+#endif//LIBNEON_EXTRACTOR_HPP
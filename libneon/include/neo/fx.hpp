@@ -5,28 +5,196 @@
 #ifndef LIBNEON_FX_HPP
 #define LIBNEON_FX_HPP
 
-#include <deque>
+#include <optional>
 #include <neo/alarm.hpp>
+#include <neo/arena.hpp>
+#include <neo/blend.hpp>
 #include <neo/color.hpp>
+#include <neo/encoder.hpp>
+#include <neo/executor.hpp>
 #include <neo/gradient.hpp>
+#include <neo/ring.hpp>
+#include <neo/tracked_buffer.hpp>
 #include <ranges>
 #include <vector>
 
 namespace neo {
 
-    class led_encoder;
-
     using color_range = std::ranges::subrange<std::vector<srgb>::iterator>;
+    using linear_color_range = std::ranges::subrange<std::vector<linear_rgb16>::iterator>;
 
     struct fx_base : public std::enable_shared_from_this<fx_base> {
-        virtual void populate(alarm const &a, color_range colors) = 0;
+        /**
+         * Value of @ref stable_until for an output that never changes.
+         */
+        static constexpr std::chrono::milliseconds forever = std::chrono::milliseconds::max();
+
+        /**
+         * Smallest tile rendered by @ref populate_tiled, below which synchronizing costs more than rendering.
+         */
+        static constexpr std::size_t min_tile_size = 64;
 
-        [[nodiscard]] std::function<void(alarm &)> make_callback(led_encoder &encoder, std::size_t num_leds);
+        fx_base() = default;
+
+        /**
+         * Does not copy the stamp of the last @ref invalidate.
+         */
+        fx_base(fx_base const &);
+        fx_base &operator=(fx_base const &);
+
+        virtual void populate(alarm const &a, color_range colors) = 0;
 
+        /**
+         * Same as @ref populate, but in linear space. Composite effects render their children through this method,
+         * so that colors are never rounded to 8 bits between stages.
+         * The default implementation calls @ref populate and converts the result.
+         */
+        virtual void populate_linear(alarm const &a, linear_color_range colors);
+
+        /**
+         * Maximum number of @ref frame_arena buffers that this effect and its children borrow at the same time while
+         * rendering. The default implementation accounts for the conversion buffer used by @ref populate_linear; effects
+         * that implement @ref populate_linear natively without scratch buffers return 0, composite effects add their
+         * own buffers to the maximum of their children.
+         */
+        [[nodiscard]] virtual std::size_t scratch_depth() const;
+
+        /**
+         * Scratch memory preallocated to render `num_leds` pixels, i.e. @ref scratch_depth slots of both @ref srgb and
+         * @ref linear_rgb16 buffers (see @ref frame_arena::reserve). @ref frame_arena::peak_bytes reports the amount
+         * actually used.
+         * @note This depends on the children at the time of the call, e.g. on the effects that a @ref transition_fx is
+         *  blending or about to blend. Callbacks made by @ref make_callback check it again before each frame, and grow
+         *  their arena before rendering if needed.
+         */
+        [[nodiscard]] std::size_t scratch_bytes(std::size_t num_leds) const;
+
+        /**
+         * If the output of @ref populate_linear at this time is the same color for every pixel, returns it; composite
+         * effects use it to blend against a constant instead of rendering a buffer. The default returns nothing.
+         */
+        [[nodiscard]] virtual std::optional<linear_rgb16> uniform_color(alarm const &a) const;
+
+        /**
+         * Time, in terms of @ref alarm::total_elapsed, up to which the output of the last call to @ref populate stays
+         * the same, assuming the parameters of this effect and of its children are not modified. Composite effects
+         * return the earliest time among their children. The default implementation returns `a.total_elapsed()`, i.e.
+         * the output may change at every frame; static effects return @ref forever.
+         */
+        [[nodiscard]] virtual std::chrono::milliseconds stable_until(alarm const &a) const;
+
+        /**
+         * Forces callbacks created with @ref make_callback that skip stable frames to render the next frame even if
+         * @ref stable_until says otherwise. Call it on an effect after modifying its parameters, or on the root effect
+         * after changing the settings of the extractor. Every callback rendering this effect notices it, also through
+         * composite effects.
+         */
+        void invalidate();
+
+        /**
+         * @return Stamp of the latest @ref invalidate called on this effect or on any of its children, 0 if none.
+         * Stamps come from a global counter, so every call to @ref invalidate changes the result; each callback compares
+         * it with the stamp it saw at the previous frame, thus effects can be shared by several callbacks and graphs.
+         * Composite effects must override this and return the latest stamp among theirs and their children's, see
+         * @ref latest_invalidation.
+         */
+        [[nodiscard]] virtual std::uint32_t last_invalidation() const;
+
+        /**
+         * Called once per frame before @ref populate_tile, from the rendering thread. Computes whatever is shared by all
+         * tiles (e.g. the current rotation), so that tiles rendered at slightly different times still match.
+         * Composite effects must forward it to their children. The default does nothing.
+         */
+        virtual void prepare(alarm const &a, std::size_t num_leds);
+
+        /**
+         * True if this effect and all its children implement @ref populate_tile. The default returns false.
+         */
+        [[nodiscard]] virtual bool tile_safe() const;
+
+        /**
+         * Renders pixels `[offset, offset + tile.size())` of a frame of `num_leds` pixels, with the same result as
+         * the corresponding slice of @ref populate_linear. Called after @ref prepare, possibly concurrently on disjoint
+         * tiles from different threads, so it must not modify the effect; scratch buffers come from the
+         * @ref frame_arena of the calling thread. Only called if @ref tile_safe; the default logs an error and aborts.
+         */
+        virtual void populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const;
+
+        /**
+         * Same as @ref populate_linear, but if @ref tile_safe, splits the frame into tiles rendered via `exec`.
+         */
+        void populate_tiled(alarm const &a, linear_color_range colors, executor &exec);
+
+        /**
+         * Renders via @ref populate_linear, converts only once right before transmitting.
+         * Each frame is rendered while the previous ones are still being transmitted, after waiting for a free buffer
+         * in `encoder` (see @ref led_encoder::wait_free_buffer), so that the time it is rendered for is not stale.
+         * @param skip_stable_frames If true, frames are neither rendered nor transmitted while the output is stable, see
+         *  @ref stable_until. Then, after changing the parameters of an effect, call @ref invalidate, otherwise the
+         *  change does not show.
+         */
+        [[nodiscard]] std::function<void(alarm &)> make_callback(led_encoder &encoder, std::size_t num_leds, bool skip_stable_frames = false);
+
+        /**
+         * Same as @ref make_callback, but renders via @ref populate_tiled on `exec`, which must outlive the callback.
+         * Tiles are joined before transmitting.
+         */
+        [[nodiscard]] std::function<void(alarm &)> make_tiled_callback(led_encoder &encoder, std::size_t num_leds, executor &exec,
+                                                                       bool skip_stable_frames = false);
+
+#if LIBNEON_DIRECT_TRANSMIT
+        /**
+         * Same as @ref make_callback, but streams the frame for very long strips: if @ref tile_safe, it is rendered via
+         * @ref populate_tile in chunks of `chunk_leds`, into a ring of `num_slots` chunks that the RMT interrupt encodes
+         * while the next chunks are rendered (see @ref led_encoder::transmit_stream), so memory does not grow with the
+         * strip. Other effects are rendered into a buffer of `num_leds` instead, allocated on first use, and sent via
+         * @ref led_encoder::transmit_direct.
+         * @note The callback returns only after rendering the last chunk, i.e. after most of the frame is transmitted.
+         *  If a chunk is not rendered by the time it is needed, its LEDs are sent black, and a warning is logged.
+         *  Requires ESP-IDF 5.3 or later and no `CONFIG_RMT_ISR_IRAM_SAFE`, see @ref LIBNEON_DIRECT_TRANSMIT.
+         */
+        [[nodiscard]] std::function<void(alarm &)> make_stream_callback(led_encoder &encoder, std::size_t num_leds, std::size_t chunk_leds = min_tile_size,
+                                                                        std::size_t num_slots = 4, bool skip_stable_frames = false);
+#endif
+
+        /**
+         * @param extractor If it can extract @ref linear_rgb16 colors, it renders via @ref populate_linear, otherwise
+         *  via @ref populate.
+         * @param skip_stable_frames Same as in @ref make_callback, but ignored for a @ref frame_stateful_extractor,
+         *  which must see every frame.
+         */
         template <class Extractor>
-        [[nodiscard]] std::function<void(alarm &)> make_callback(led_encoder &encoder, std::size_t num_leds, Extractor extractor);
+        [[nodiscard]] std::function<void(alarm &)> make_callback(led_encoder &encoder, std::size_t num_leds, Extractor extractor,
+                                                                 bool skip_stable_frames = false);
 
         virtual ~fx_base() = default;
+
+    protected:
+        /**
+         * Implements @ref populate by calling @ref populate_linear and converting the result. Use this in effects that
+         * work natively in linear space.
+         */
+        void populate_via_linear(alarm const &a, color_range colors);
+
+        /**
+         * @return The later of two stamps returned by @ref last_invalidation, accounting for wrap around.
+         */
+        [[nodiscard]] static constexpr std::uint32_t latest_invalidation(std::uint32_t l, std::uint32_t r);
+
+        /**
+         * @return The later of `stamp` and the @ref last_invalidation of `fx`, or `stamp` if `fx` is null.
+         */
+        [[nodiscard]] static std::uint32_t latest_invalidation(std::uint32_t stamp, std::shared_ptr<fx_base> const &fx);
+
+    private:
+        std::atomic<std::uint32_t> _invalidated_at = 0;
+
+        /**
+         * @param valid_until Value of @ref stable_until after the last frame was rendered.
+         * @param seen_invalidation Value of @ref last_invalidation when the last frame was rendered; it is updated.
+         * @return True if the last frame is still valid at `a.total_elapsed()` and @ref invalidate was not called since.
+         */
+        [[nodiscard]] bool can_skip_frame(alarm const &a, std::chrono::milliseconds valid_until, std::uint32_t &seen_invalidation) const;
     };
 
     struct solid_fx : fx_base {
@@ -37,18 +205,116 @@ namespace neo {
 
 
         void populate(alarm const &, color_range colors) override;
+        void populate_linear(alarm const &, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        [[nodiscard]] std::optional<linear_rgb16> uniform_color(alarm const &a) const override;
+        [[nodiscard]] bool tile_safe() const override;
+        void populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const override;
     };
 
     struct gradient_fx : fx_base {
         std::vector<gradient_entry> gradient = {};
         std::chrono::milliseconds rotate_cycle_time = 0ms;
         float scale = 1.f;
+        gradient_mode mode = gradient_mode::linear;
+        /**
+         * If false, pixels take the color of the nearest texel of the baked gradient, without interpolating.
+         */
+        bool interpolate = true;
 
         gradient_fx() = default;
-        inline explicit gradient_fx(std::vector<gradient_entry> gradient_, std::chrono::milliseconds rotate_cycle_time_ = 2s, float scale_ = 1.f);
-        inline explicit gradient_fx(std::vector<srgb> gradient_, std::chrono::milliseconds rotate_cycle_time_ = 2s, float scale_ = 1.f);
+        inline explicit gradient_fx(std::vector<gradient_entry> gradient_, std::chrono::milliseconds rotate_cycle_time_ = 2s, float scale_ = 1.f, gradient_mode mode_ = gradient_mode::linear);
+        inline explicit gradient_fx(std::vector<srgb> gradient_, std::chrono::milliseconds rotate_cycle_time_ = 2s, float scale_ = 1.f, gradient_mode mode_ = gradient_mode::linear);
 
         void populate(alarm const &a, color_range colors) override;
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        void prepare(alarm const &a, std::size_t num_leds) override;
+        [[nodiscard]] bool tile_safe() const override;
+        void populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const override;
+
+    private:
+        gradient_texture _texture;
+        /**
+         * Set by @ref prepare.
+         */
+        float _rotation = 0.f;
+        /**
+         * What @ref _texture was baked from, so that it is rebaked automatically when @ref gradient or @ref mode change.
+         */
+        std::vector<gradient_entry> _baked_gradient;
+        gradient_mode _baked_mode = gradient_mode::linear;
+        bool _baked = false;
+
+        void bake_if_changed();
+    };
+
+    /**
+     * Morphs back and forth between the gradients `from` and `to` every `morph_cycle_time`, while rotating like
+     * @ref gradient_fx. Entries are paired by index, and their positions and colors are interpolated, so the morphed
+     * gradient is sampled once, without rendering the two gradients separately.
+     * If the gradients have a different number of entries, the entries of the shorter one are repeated evenly.
+     */
+    struct gradient_morph_fx : fx_base {
+        std::vector<gradient_entry> from = {};
+        std::vector<gradient_entry> to = {};
+        std::chrono::milliseconds morph_cycle_time = 0ms;
+        std::chrono::milliseconds rotate_cycle_time = 0ms;
+        float scale = 1.f;
+
+        gradient_morph_fx() = default;
+        inline gradient_morph_fx(std::vector<gradient_entry> from_, std::vector<gradient_entry> to_, std::chrono::milliseconds morph_cycle_time_ = 2s,
+                                 std::chrono::milliseconds rotate_cycle_time_ = 0ms, float scale_ = 1.f);
+
+        void populate(alarm const &a, color_range colors) override;
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+
+    private:
+        std::vector<gradient_entry> _morphed;
+
+        void morph(alarm const &a);
+    };
+
+    /**
+     * Spreads `scale` turns of the hue wheel along the strip, at constant saturation and value, and rotates them by one
+     * turn every `rotate_cycle_time`. Renders via @ref hsv16 and @ref convert_batch, i.e. with integer math only.
+     */
+    struct hue_rotate_fx : fx_base {
+        std::chrono::milliseconds rotate_cycle_time = 0ms;
+        float scale = 1.f;
+        float saturation = 1.f;
+        float value = 1.f;
+
+        hue_rotate_fx() = default;
+        inline explicit hue_rotate_fx(std::chrono::milliseconds rotate_cycle_time_, float scale_ = 1.f, float saturation_ = 1.f, float value_ = 1.f);
+
+        void populate(alarm const &a, color_range colors) override;
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+
+        void prepare(alarm const &a, std::size_t num_leds) override;
+        [[nodiscard]] bool tile_safe() const override;
+        void populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const override;
+
+    private:
+        std::vector<hsv16> _buffer;
+        /**
+         * Set by @ref prepare: hue of the first pixel and hue step between pixels, as in @ref unit_to_phase.
+         */
+        std::uint32_t _hue_phase = 0;
+        std::uint32_t _hue_step = 0;
+
+        void populate_hsv(alarm const &a, std::size_t num_leds);
+
+        /**
+         * Fills `out` with pixels `[offset, offset + out.size())`, after @ref prepare.
+         */
+        void fill_hsv(std::span<hsv16> out, std::size_t offset) const;
     };
 
     template <class>
@@ -64,6 +330,17 @@ namespace neo {
     [[nodiscard]] std::shared_ptr<fx_base> wrap(T &&fx);
 
 
+    namespace detail {
+        /**
+         * State of a blend between two effects computed by @ref fx_base::prepare, for @ref fx_base::populate_tile.
+         */
+        struct prepared_blend {
+            float factor = 0.f;
+            std::optional<linear_rgb16> lo_col = std::nullopt;
+            std::optional<linear_rgb16> hi_col = std::nullopt;
+        };
+    }// namespace detail
+
     struct pulse_fx : fx_base {
         std::shared_ptr<fx_base> lo = {};
         std::shared_ptr<fx_base> hi = {};
@@ -75,34 +352,81 @@ namespace neo {
         pulse_fx(Fx1 lo_, Fx2 hi_, std::chrono::milliseconds cycle_time_ = 2s);
 
         void populate(alarm const &a, color_range colors) override;
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        [[nodiscard]] std::optional<linear_rgb16> uniform_color(alarm const &a) const override;
+        [[nodiscard]] std::uint32_t last_invalidation() const override;
+        void prepare(alarm const &a, std::size_t num_leds) override;
+        [[nodiscard]] bool tile_safe() const override;
+        void populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const override;
 
     private:
-        std::vector<srgb> _buffer;
+        detail::prepared_blend _prepared;
+
+        [[nodiscard]] float blend_factor(alarm const &a) const;
     };
 
+    /**
+     * Fades from the current effect to the next one every time @ref transition_to is called.
+     * At most two effects are rendered per frame, no matter how many transitions are requested: if a transition starts
+     * while another one is in progress, the blended output is frozen into a snapshot, which is then faded out.
+     * Requests go through a lock-free queue, so @ref transition_to can be called from another task than the one
+     * rendering, and do not allocate (except for the snapshot buffer, once).
+     * @note Must be used through `std::shared_ptr`, it cannot be copied.
+     */
     class transition_fx : public fx_base {
         struct transition {
-            std::chrono::milliseconds activation_time;
-            std::chrono::milliseconds transition_duration;
-            std::shared_ptr<fx_base> fx;
+            std::chrono::milliseconds activation_time = 0ms;
+            std::chrono::milliseconds transition_duration = 0ms;
+            std::shared_ptr<fx_base> fx = nullptr;
 
             [[nodiscard]] bool is_complete(std::chrono::milliseconds t) const;
             [[nodiscard]] float compute_blend_factor(std::chrono::milliseconds t) const;
         };
 
-        std::deque<transition> _active_transitions;
-        std::vector<srgb> _buffer;
-
-        void pop_expired(std::chrono::milliseconds t);
+        spsc_ring<transition, 8> _requests;
+        /**
+         * Effect being faded in, or which is displayed if the transition is complete.
+         */
+        transition _target;
+        /**
+         * Effect being faded out. If null, the snapshot is faded out if @ref _snapshot_active, otherwise black.
+         */
+        std::shared_ptr<fx_base> _source = nullptr;
+        std::vector<linear_rgb16> _snapshot;
+        bool _snapshot_active = false;
+
+        /**
+         * Starts the most recent request, discarding the others, which were issued during the last frame.
+         */
+        void start_requested(alarm const &a, std::size_t num_leds);
+
+        void populate_current(alarm const &a, linear_color_range colors);
 
     public:
+        /**
+         * If true, also a single outgoing effect is frozen when a transition starts, so that only the incoming effect
+         * is rendered while transitioning. Otherwise, it keeps being animated while it fades out.
+         */
+        bool freeze_outgoing = false;
+
         transition_fx() = default;
         void populate(alarm const &a, color_range colors) override;
-
-        void transition_to(alarm const &a, std::shared_ptr<fx_base> fx, std::chrono::milliseconds duration);
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        [[nodiscard]] std::optional<linear_rgb16> uniform_color(alarm const &a) const override;
+        [[nodiscard]] std::uint32_t last_invalidation() const override;
+
+        /**
+         * Starts fading to `fx` at the next frame.
+         * @return False if too many requests are pending and this one was dropped.
+         */
+        bool transition_to(alarm const &a, std::shared_ptr<fx_base> fx, std::chrono::milliseconds duration);
 
         template <fx_or_fx_ptr Fx>
-        void transition_to(alarm const &a, Fx fx, std::chrono::milliseconds duration);
+        bool transition_to(alarm const &a, Fx fx, std::chrono::milliseconds duration);
     };
 
     struct blend_fx : fx_base {
@@ -116,26 +440,193 @@ namespace neo {
         blend_fx(Fx1 lo_, Fx2 hi_, float blend_factor_ = 0.5f);
 
         void populate(alarm const &a, color_range colors) override;
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        [[nodiscard]] std::optional<linear_rgb16> uniform_color(alarm const &a) const override;
+        [[nodiscard]] std::uint32_t last_invalidation() const override;
+        void prepare(alarm const &a, std::size_t num_leds) override;
+        [[nodiscard]] bool tile_safe() const override;
+        void populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const override;
 
     private:
-        std::vector<srgb> _buffer;
+        detail::prepared_blend _prepared;
+    };
+
+    /**
+     * Stacks any number of effects, each combined with the ones below via a @ref blend_mode, an opacity and optionally
+     * a per-pixel mask. Unlike nested @ref blend_fx, all layers are composited in a single pass over the frame; each
+     * layer is rendered once into its own buffer, layers and masks of a uniform color are not rendered at all.
+     * Layers below one which is fully opaque, unmasked and in @ref blend_mode::normal are skipped.
+     */
+    struct layer_fx : fx_base {
+        struct layer {
+            /**
+             * If null, renders black.
+             */
+            std::shared_ptr<fx_base> fx = nullptr;
+            blend_mode mode = blend_mode::normal;
+            float opacity = 1.f;
+            /**
+             * Per-pixel opacity, multiplied by @ref opacity: the luminance of its output, so white is fully opaque.
+             * If null, @ref opacity applies to all pixels.
+             */
+            std::shared_ptr<fx_base> mask = nullptr;
+        };
+
+        /**
+         * From the bottom to the top. The bottom layer is composited over black.
+         */
+        std::vector<layer> layers;
+
+        layer_fx() = default;
+        inline explicit layer_fx(std::vector<layer> layers_);
+
+        void populate(alarm const &a, color_range colors) override;
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        [[nodiscard]] std::optional<linear_rgb16> uniform_color(alarm const &a) const override;
+        [[nodiscard]] std::uint32_t last_invalidation() const override;
+
+    private:
+        /**
+         * Either a rendered buffer, or a constant if `data` is null.
+         */
+        struct plane {
+            linear_rgb16 const *data = nullptr;
+            linear_rgb16 constant = {};
+
+            [[nodiscard]] linear_rgb16 operator[](std::size_t i) const;
+        };
+
+        /**
+         * A visible layer, as composited in the current frame.
+         */
+        struct source {
+            plane color = {};
+            /**
+             * Only used if `masked`.
+             */
+            plane mask = {};
+            bool masked = false;
+            blend_mode mode = blend_mode::normal;
+            /**
+             * Opacity as a @ref unit_to_fixed weight if not `masked`, otherwise as 0...0xffff.
+             */
+            std::uint32_t weight = 0;
+
+            /**
+             * @return True if this covers completely the layers below.
+             */
+            [[nodiscard]] bool is_opaque() const;
+        };
+
+        struct pending_plane {
+            fx_base *fx = nullptr;
+            plane *target = nullptr;
+        };
+
+        std::vector<source> _sources;
+        std::vector<pending_plane> _pending;
+
+        /**
+         * @return The mode and weight of `l`, folding its mask into the weight if it is uniform. Planes are not set.
+         */
+        [[nodiscard]] static source make_source(layer const &l, alarm const &a);
+
+        /**
+         * Fills @ref _sources with the visible layers, and @ref _pending with the planes that must be rendered.
+         */
+        void collect_sources(alarm const &a);
+
+        /**
+         * Renders the `i`-th pending plane and the following ones, each in a buffer borrowed while rendering the next,
+         * then composites. The first plane is rendered directly into `colors`.
+         */
+        void render_pending(alarm const &a, linear_color_range colors, std::size_t i);
+
+        void composite_sources(linear_color_range colors) const;
+    };
+
+    /**
+     * Splits a strip into zones, each showing its own effect. Every effect renders directly into its slice of the
+     * frame, and sees the slice as a whole strip (e.g. a @ref gradient_fx spans the zone, not the strip), so that a single
+     * callback made with @ref make_callback drives all zones with one extraction and one transmission per frame.
+     * Pixels not covered by any zone are black. If zones overlap, later zones overwrite earlier ones.
+     */
+    struct zones_fx : fx_base {
+        struct zone {
+            /**
+             * Indices in the strip; the part beyond the end of the strip is ignored.
+             */
+            index_span span = {};
+            /**
+             * If null, renders black.
+             */
+            std::shared_ptr<fx_base> fx = nullptr;
+            /**
+             * Index 0 of the effect is at the end of the span (at the center, if @ref mirrored).
+             */
+            bool reversed = false;
+            /**
+             * The effect renders only the first half of the span, which is then mirrored onto the second half.
+             */
+            bool mirrored = false;
+        };
+
+        std::vector<zone> zones;
+
+        zones_fx() = default;
+        inline explicit zones_fx(std::vector<zone> zones_);
+
+        void populate(alarm const &a, color_range colors) override;
+        void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        [[nodiscard]] std::uint32_t last_invalidation() const override;
+
+    private:
+        /**
+         * Spans of @ref zones, sorted, reused across frames to find the uncovered pixels.
+         */
+        std::vector<index_span> _sorted_spans;
+
+        template <class Color>
+        void populate_zones(alarm const &a, std::ranges::subrange<typename std::vector<Color>::iterator> colors);
     };
 
 }// namespace neo
 
 namespace neo {
-    gradient_fx::gradient_fx(std::vector<gradient_entry> gradient_, std::chrono::milliseconds rotate_cycle_time_, float scale_)
+    gradient_fx::gradient_fx(std::vector<gradient_entry> gradient_, std::chrono::milliseconds rotate_cycle_time_, float scale_, gradient_mode mode_)
         : gradient{std::move(gradient_)},
           rotate_cycle_time{rotate_cycle_time_},
-          scale{scale_} {}
+          scale{scale_},
+          mode{mode_} {}
 
-    gradient_fx::gradient_fx(std::vector<srgb> gradient_, std::chrono::milliseconds rotate_cycle_time_, float scale_)
+    gradient_fx::gradient_fx(std::vector<srgb> gradient_, std::chrono::milliseconds rotate_cycle_time_, float scale_, gradient_mode mode_)
         : gradient{neo::gradient_make_uniform_from_colors(std::move(gradient_))},
           rotate_cycle_time{rotate_cycle_time_},
-          scale{scale_} {}
+          scale{scale_},
+          mode{mode_} {}
 
     solid_fx::solid_fx(neo::srgb color_) : color{color_} {}
 
+    gradient_morph_fx::gradient_morph_fx(std::vector<gradient_entry> from_, std::vector<gradient_entry> to_, std::chrono::milliseconds morph_cycle_time_,
+                                         std::chrono::milliseconds rotate_cycle_time_, float scale_)
+        : from{std::move(from_)},
+          to{std::move(to_)},
+          morph_cycle_time{morph_cycle_time_},
+          rotate_cycle_time{rotate_cycle_time_},
+          scale{scale_} {}
+
+    hue_rotate_fx::hue_rotate_fx(std::chrono::milliseconds rotate_cycle_time_, float scale_, float saturation_, float value_)
+        : rotate_cycle_time{rotate_cycle_time_},
+          scale{scale_},
+          saturation{saturation_},
+          value{value_} {}
+
     template <fx_or_fx_ptr Fx1, fx_or_fx_ptr Fx2>
     pulse_fx::pulse_fx(Fx1 lo_, Fx2 hi_, std::chrono::milliseconds cycle_time_)
         : lo{wrap(std::move(lo_))}, hi{wrap(std::move(hi_))}, cycle_time{cycle_time_} {}
@@ -155,17 +646,58 @@ namespace neo {
         : lo{wrap(std::move(lo_))}, hi{wrap(std::move(hi_))}, blend_factor{blend_factor_} {}
 
 
+    constexpr std::uint32_t fx_base::latest_invalidation(std::uint32_t l, std::uint32_t r) {
+        return std::int32_t(r - l) > 0 ? r : l;
+    }
+
+    layer_fx::layer_fx(std::vector<layer> layers_) : layers{std::move(layers_)} {}
+
+    zones_fx::zones_fx(std::vector<zone> zones_) : zones{std::move(zones_)} {}
+
     template <fx_or_fx_ptr Fx>
-    void transition_fx::transition_to(alarm const &a, Fx fx, std::chrono::milliseconds duration) {
-        transition_to(a, neo::wrap(std::move(fx)), duration);
+    bool transition_fx::transition_to(alarm const &a, Fx fx, std::chrono::milliseconds duration) {
+        return transition_to(a, neo::wrap(std::move(fx)), duration);
     }
 
     template <class Extractor>
-    std::function<void(alarm &)> fx_base::make_callback(led_encoder &encoder, std::size_t num_leds, Extractor extractor) {
-        return [fx = shared_from_this(), buffer = std::vector<neo::srgb>{num_leds}, enc = &encoder, extractor = extractor](neo::alarm &a) mutable {
-            fx->populate(a, buffer);
-            ESP_ERROR_CHECK(enc->transmit(std::begin(buffer), std::end(buffer), extractor));
-        };
+    std::function<void(alarm &)> fx_base::make_callback(led_encoder &encoder, std::size_t num_leds, Extractor extractor, bool skip_stable_frames) {
+        if constexpr (std::is_invocable_v<Extractor const &, linear_rgb16, channel>) {
+            frame_arena arena{};
+            arena.reserve(scratch_depth(), num_leds);
+            return [fx = shared_from_this(), buffer = std::vector<neo::linear_rgb16>{num_leds}, arena = std::move(arena), enc = &encoder, extractor = extractor,
+                    num_leds, skip_stable_frames, valid_until = 0ms, seen_invalidation = std::uint32_t(0)](neo::alarm &a) mutable {
+                if constexpr (not frame_stateful_extractor<Extractor>) {
+                    if (skip_stable_frames and fx->can_skip_frame(a, valid_until, seen_invalidation)) {
+                        return;
+                    }
+                }
+                ESP_ERROR_CHECK(enc->wait_free_buffer());
+                // Children may have changed since the last frame, grow the arena now rather than while rendering
+                arena.reserve(fx->scratch_depth(), num_leds);
+                const frame_arena::scope scope{arena};
+                fx->populate_linear(a, buffer);
+                valid_until = fx->stable_until(a);
+                ESP_ERROR_CHECK(enc->transmit(std::begin(buffer), std::end(buffer), extractor));
+            };
+        } else {
+            frame_arena arena{};
+            // One more level, for effects that implement populate via populate_linear
+            arena.reserve(scratch_depth() + 1, num_leds);
+            return [fx = shared_from_this(), buffer = std::vector<neo::srgb>{num_leds}, arena = std::move(arena), enc = &encoder, extractor = extractor,
+                    num_leds, skip_stable_frames, valid_until = 0ms, seen_invalidation = std::uint32_t(0)](neo::alarm &a) mutable {
+                if constexpr (not frame_stateful_extractor<Extractor>) {
+                    if (skip_stable_frames and fx->can_skip_frame(a, valid_until, seen_invalidation)) {
+                        return;
+                    }
+                }
+                ESP_ERROR_CHECK(enc->wait_free_buffer());
+                arena.reserve(fx->scratch_depth() + 1, num_leds);
+                const frame_arena::scope scope{arena};
+                fx->populate(a, buffer);
+                valid_until = fx->stable_until(a);
+                ESP_ERROR_CHECK(enc->transmit(std::begin(buffer), std::end(buffer), extractor));
+            };
+        }
     }
 }// namespace neo
 
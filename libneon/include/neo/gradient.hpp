@@ -5,20 +5,35 @@
 #ifndef NEO_GRADIENT_HPP
 #define NEO_GRADIENT_HPP
 
+#include <array>
+#include <iterator>
+#include <neo/blend.hpp>
 #include <neo/color.hpp>
 #include <neo/math.hpp>
+#include <neo/oklab.hpp>
 
 namespace neo {
     using blend_fn_t = srgb (&)(srgb l, srgb r, float t);
 
     [[maybe_unused]] [[nodiscard]] inline srgb blend_lerp(srgb l, srgb r, float t);
     [[maybe_unused]] [[nodiscard]] inline srgb blend_linear(srgb l, srgb r, float t);
-    [[maybe_unused]] [[nodiscard]] inline srgb blend_round_down(srgb l, srgb, float);
-    [[maybe_unused]] [[nodiscard]] inline srgb blend_round_up(srgb, srgb r, float);
+    [[maybe_unused]] [[nodiscard]] inline srgb blend_linear_lut(srgb l, srgb r, float t);
+    [[maybe_unused]] [[nodiscard]] inline srgb blend_lerp_fixed(srgb l, srgb r, float t);
+    [[maybe_unused]] [[nodiscard]] inline srgb blend_round_down(srgb l, srgb r, float t);
+    [[maybe_unused]] [[nodiscard]] inline srgb blend_round_up(srgb l, srgb r, float t);
     [[maybe_unused]] [[nodiscard]] inline srgb blend_nearest_neighbor(srgb l, srgb r, float t);
 
-    template <class FwdIt1, class FwdIt2, class OutIt>
-    OutIt broadcast_blend(FwdIt1 l_begin, FwdIt1 l_end, FwdIt2 r_begin, FwdIt2 r_end, OutIt out, float t, blend_fn_t blend_fn = blend_linear);
+    /**
+     * Blends in @ref oklab. When sampling gradients prefer @ref blend_op::oklab, which caches the endpoints.
+     */
+    [[maybe_unused]] [[nodiscard]] inline srgb blend_oklab(srgb l, srgb r, float t);
+
+    /**
+     * @note `blend_fn` can be any @ref blend_fn_t, but @ref blend_op functors can be inlined, and when all the iterators
+     *  are contiguous, they are processed in batch via @ref blend_batch.
+     */
+    template <class FwdIt1, class FwdIt2, class OutIt, srgb_blend_fn BlendFn = blend_op::linear>
+    OutIt broadcast_blend(FwdIt1 l_begin, FwdIt1 l_end, FwdIt2 r_begin, FwdIt2 r_end, OutIt out, float t, BlendFn blend_fn = {});
 
     struct gradient_entry {
         float pos = 0.f;
@@ -26,6 +41,16 @@ namespace neo {
 
         constexpr gradient_entry() = default;
         constexpr gradient_entry(float pos_, srgb col_) : pos{pos_}, col{col_} {}
+
+        constexpr bool operator==(gradient_entry const &other) const = default;
+    };
+
+    /**
+     * Color space in which gradients are interpolated between entries.
+     */
+    enum struct gradient_mode : std::uint8_t {
+        linear,///< Linear light, same as @ref blend_linear
+        oklab  ///< Perceptual, same as @ref blend_oklab
     };
 
     struct safe_less {
@@ -38,8 +63,13 @@ namespace neo {
         [[nodiscard]] constexpr bool operator()(gradient_entry const &l, gradient_entry const &r) const;
     };
 
-    template <class It, class OutIt>
-    OutIt gradient_sample(It begin, It end, std::size_t n, OutIt out, float rotate = 0.f, float scale = 1.f, blend_fn_t blend_fn = blend_linear);
+    /**
+     * @note `blend_fn` may also return a different color type (e.g. @ref linear_rgb16), as long as it can be
+     *  constructed from @ref srgb; that is what is output for samples lying outside of the gradient.
+     */
+    template <class It, class OutIt, class BlendFn = blend_op::linear>
+        requires std::is_invocable_v<BlendFn &, srgb, srgb, float>
+    OutIt gradient_sample(It begin, It end, std::size_t n, OutIt out, float rotate = 0.f, float scale = 1.f, BlendFn blend_fn = {});
 
     template <class It>
     void gradient_normalize(It begin, It end);
@@ -51,6 +81,52 @@ namespace neo {
     template <class Container = std::vector<gradient_entry>>
     [[nodiscard]] Container gradient_make_uniform_from_colors(std::vector<srgb> colors);
 
+    /**
+     * A gradient baked into @ref resolution texels in linear space, so that it can be sampled without searching the
+     * entries nor blending. Sampling walks the texture with a 32-bit fixed point phase, which wraps around by itself,
+     * and optionally interpolates between adjacent texels.
+     */
+    class gradient_texture {
+    public:
+        static constexpr std::size_t resolution = 256;
+
+        gradient_texture() = default;
+
+        /**
+         * Samples the gradient at @ref resolution equally spaced positions in 0...1.
+         */
+        void bake(std::span<const gradient_entry> gradient, gradient_mode mode = gradient_mode::linear);
+
+        /**
+         * Same as calling @ref gradient_sample with @ref out.size() samples and the given `rotate` and `scale` on the
+         * baked gradient.
+         */
+        void sample(std::span<linear_rgb16> out, float rotate = 0.f, float scale = 1.f, bool interpolate = true) const;
+
+        /**
+         * @copydoc sample
+         */
+        void sample(std::span<srgb> out, float rotate = 0.f, float scale = 1.f, bool interpolate = true) const;
+
+        /**
+         * Samples `[offset, offset + out.size())` out of `num_samples`, with the same result as the corresponding slice
+         * of @ref sample with `num_samples` samples.
+         */
+        void sample_slice(std::span<linear_rgb16> out, std::size_t offset, std::size_t num_samples, float rotate = 0.f, float scale = 1.f,
+                          bool interpolate = true) const;
+
+        [[nodiscard]] inline linear_rgb16 texel_at(std::uint32_t phase, bool interpolate) const;
+
+    private:
+        /**
+         * The last texel is the color at position 1, so that the last interval can be interpolated too.
+         */
+        std::array<linear_rgb16, resolution + 1> _texels{};
+
+        template <class Color>
+        void sample_impl(std::span<Color> out, std::size_t offset, std::size_t num_samples, float rotate, float scale, bool interpolate) const;
+    };
+
 }// namespace neo
 
 namespace neo {
@@ -71,27 +147,41 @@ namespace neo {
     }
 
     srgb blend_lerp(srgb l, srgb r, float t) {
-        return l.lerp(r, t);
+        return blend_op::lerp{}(l, r, t);
     }
 
     srgb blend_linear(srgb l, srgb r, float t) {
-        return l.blend(r, t);
+        return blend_op::linear{}(l, r, t);
+    }
+
+    srgb blend_linear_lut(srgb l, srgb r, float t) {
+        return blend_op::linear_lut{}(l, r, t);
+    }
+
+    srgb blend_lerp_fixed(srgb l, srgb r, float t) {
+        return blend_op::lerp_fixed{}(l, r, t);
     }
 
-    srgb blend_round_down(srgb l, srgb, float) {
-        return l;
+    srgb blend_round_down(srgb l, srgb r, float t) {
+        return blend_op::round_down{}(l, r, t);
     }
 
-    srgb blend_round_up(srgb, srgb r, float) {
-        return r;
+    srgb blend_round_up(srgb l, srgb r, float t) {
+        return blend_op::round_up{}(l, r, t);
     }
 
     srgb blend_nearest_neighbor(srgb l, srgb r, float t) {
-        return safe_less{}(t, 0.5f) ? l : r;
+        return blend_op::nearest_neighbor{}(l, r, t);
     }
 
-    template <class It, class OutIt>
-    OutIt gradient_sample(It begin, It end, std::size_t n, OutIt out, float rotate, float scale, blend_fn_t blend_fn) {
+    srgb blend_oklab(srgb l, srgb r, float t) {
+        return blend_op::oklab{}(l, r, t);
+    }
+
+    template <class It, class OutIt, class BlendFn>
+        requires std::is_invocable_v<BlendFn &, srgb, srgb, float>
+    OutIt gradient_sample(It begin, It end, std::size_t n, OutIt out, float rotate, float scale, BlendFn blend_fn) {
+        using color_t = std::invoke_result_t<BlendFn &, srgb, srgb, float>;
         if (begin == end) {
             return out;
         }
@@ -103,12 +193,12 @@ namespace neo {
             ub = std::upper_bound(less(t, last_t) ? begin : ub, end, t, less);
             last_t = t;
             if (ub == begin) {
-                *(out++) = begin->col;
+                *(out++) = color_t{begin->col};
                 continue;
             }
             auto lb = std::prev(ub);
             if (ub == end) {
-                *(out++) = lb->col;
+                *(out++) = color_t{lb->col};
                 continue;
             }
             const float blend_f = std::clamp((t - lb->pos) / (ub->pos - lb->pos), 0.f, 1.f);
@@ -151,12 +241,31 @@ namespace neo {
         return c;
     }
 
-    template <class FwdIt1, class FwdIt2, class OutIt>
-    OutIt broadcast_blend(FwdIt1 l_begin, FwdIt1 l_end, FwdIt2 r_begin, FwdIt2 r_end, OutIt out, float t, blend_fn_t blend_fn) {
-        for (; l_begin != l_end and r_begin != r_end; ++l_begin, ++r_begin) {
-            *(out++) = blend_fn(*l_begin, *r_begin, t);
+    linear_rgb16 gradient_texture::texel_at(std::uint32_t phase, bool interpolate) const {
+        static_assert(resolution == 0x100, "The phase-to-texel mapping assumes 256 texels.");
+        const std::size_t i = phase >> 24;
+        if (not interpolate) {
+            return _texels[i];
+        }
+        return _texels[i].blend_fixed(_texels[i + 1], (phase >> 8) & 0xffff);
+    }
+
+    template <class FwdIt1, class FwdIt2, class OutIt, srgb_blend_fn BlendFn>
+    OutIt broadcast_blend(FwdIt1 l_begin, FwdIt1 l_end, FwdIt2 r_begin, FwdIt2 r_end, OutIt out, float t, BlendFn blend_fn) {
+        if constexpr (std::contiguous_iterator<FwdIt1> and std::contiguous_iterator<FwdIt2> and std::contiguous_iterator<OutIt> and
+                      std::is_same_v<std::iter_value_t<FwdIt1>, srgb> and std::is_same_v<std::iter_value_t<FwdIt2>, srgb> and
+                      std::is_same_v<std::iter_value_t<OutIt>, srgb>) {
+            const auto n = std::min(std::distance(l_begin, l_end), std::distance(r_begin, r_end));
+            const std::span<const srgb> l{std::to_address(l_begin), std::size_t(n)};
+            const std::span<const srgb> r{std::to_address(r_begin), std::size_t(n)};
+            const std::span<srgb> o{std::to_address(out), std::size_t(n)};
+            return std::next(out, blend_batch(l, r, o, t, blend_fn));
+        } else {
+            for (; l_begin != l_end and r_begin != r_end; ++l_begin, ++r_begin) {
+                *(out++) = blend_fn(*l_begin, *r_begin, t);
+            }
+            return out;
         }
-        return out;
     }
 }// namespace neo
 #endif//NEO_GRADIENT_HPP
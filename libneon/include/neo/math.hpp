@@ -7,13 +7,52 @@
 
 #include <algorithm>
 #include <cmath>
+#include <concepts>
 #include <cstdint>
+#include <type_traits>
 
 namespace neo {
     [[nodiscard]] constexpr float modclamp(float f, float low = 0.f, float high = 1.f);
 
     [[nodiscard]] constexpr std::uint8_t unit_to_byte(float f);
     [[nodiscard]] constexpr float byte_to_unit(std::uint8_t b);
+
+    /**
+     * Converts a blend factor in the range 0...1 into a fixed point weight in the range 0...0x10000.
+     */
+    [[nodiscard]] constexpr std::uint32_t unit_to_fixed(float f);
+
+    /**
+     * Blends two 16-bit values using a weight obtained from @ref unit_to_fixed. Uses only 32-bit integer arithmetic.
+     */
+    [[nodiscard]] constexpr std::uint16_t lerp_fixed(std::uint16_t l, std::uint16_t r, std::uint32_t weight);
+
+    /**
+     * Converts a value in the range 0...1 into the range 0...0xffff.
+     */
+    [[nodiscard]] constexpr std::uint16_t unit_to_u16(float f);
+
+    /**
+     * Converts a value in the range 0...0xffff into a fixed point weight in the range 0...0x10000, see @ref unit_to_fixed.
+     */
+    [[nodiscard]] constexpr std::uint32_t u16_to_fixed(std::uint16_t v);
+
+    /**
+     * @return `modclamp(f)` as a 32-bit fixed point fraction of a turn, which wraps around by itself when summed.
+     */
+    [[nodiscard]] constexpr std::uint32_t unit_to_phase(float f);
+
+    /**
+     * Product of two values in the range 0...0xffff, each representing 0...1, i.e. `round(a * b / 0xffff)`.
+     */
+    [[nodiscard]] constexpr std::uint16_t mul_unit16(std::uint16_t a, std::uint16_t b);
+
+    /**
+     * Same as `std::pow(base, exponent)` for `base >= 0`, but can also be evaluated at compile time, where it computes
+     * `exp(exponent * log(base))` in double precision with series expansions. At runtime, it calls `std::pow`.
+     */
+    template <std::floating_point T>
+    [[nodiscard]] constexpr T constexpr_pow(T base, T exponent);
 }// namespace neo
 
 namespace neo {
@@ -31,6 +70,93 @@ namespace neo {
         return float(b) / 255.f;
     }
 
+    constexpr std::uint32_t unit_to_fixed(float f) {
+        return std::uint32_t(std::round(std::clamp(f, 0.f, 1.f) * 65536.f));
+    }
+
+    constexpr std::uint16_t lerp_fixed(std::uint16_t l, std::uint16_t r, std::uint32_t weight) {
+        // Cannot overflow: l * (0x10000 - w) + r * w <= 0xffff * 0x10000
+        return std::uint16_t((std::uint32_t(l) * (0x10000 - weight) + std::uint32_t(r) * weight + 0x8000) >> 16);
+    }
+
+    constexpr std::uint16_t unit_to_u16(float f) {
+        return std::uint16_t(std::round(std::clamp(f, 0.f, 1.f) * 65535.f));
+    }
+
+    constexpr std::uint32_t u16_to_fixed(std::uint16_t v) {
+        // Maps 0xffff to 0x10000, and is off by at most one elsewhere
+        return std::uint32_t(v) + (v >> 15);
+    }
+
+    constexpr std::uint32_t unit_to_phase(float f) {
+        // modclamp may round tiny negatives up to exactly 1, i.e. 2^32, which only fits in 64 bits before wrapping
+        return std::uint32_t(std::uint64_t(double(modclamp(f)) * 4294967296.));
+    }
+
+    constexpr std::uint16_t mul_unit16(std::uint16_t a, std::uint16_t b) {
+        // Exact rounding of x / 0xffff for x <= 0xffff * 0xffff, using x / 0xffff = x / 0x10000 * (1 + 1 / 0x10000 + ...)
+        const std::uint32_t x = std::uint32_t(a) * b + 0x8000;
+        return std::uint16_t((x + (x >> 16)) >> 16);
+    }
+
+    namespace detail {
+        constexpr double ln2 = 0.693147180559945309417;
+
+        /**
+         * @note Requires `x > 0`.
+         */
+        [[nodiscard]] constexpr double constexpr_log(double x) {
+            // Reduce to 1 <= x < 2, then log(x) = 2 atanh((x - 1) / (x + 1)), with (x - 1) / (x + 1) <= 1/3
+            int k = 0;
+            for (; x >= 2.; x *= 0.5) {
+                ++k;
+            }
+            for (; x < 1.; x *= 2.) {
+                --k;
+            }
+            const double y = (x - 1.) / (x + 1.);
+            const double y2 = y * y;
+            double term = y;
+            double sum = 0.;
+            for (int n = 1; n < 40; n += 2, term *= y2) {
+                sum += term / n;
+            }
+            return 2. * sum + k * ln2;
+        }
+
+        [[nodiscard]] constexpr double constexpr_exp(double x) {
+            // Reduce to |r| <= ln2 / 2, then exp(x) = 2^k exp(r)
+            const auto k = static_cast<long>(x / ln2 + (x < 0. ? -0.5 : 0.5));
+            const double r = x - double(k) * ln2;
+            double term = 1.;
+            double sum = 1.;
+            for (int n = 1; n < 24; ++n) {
+                term *= r / n;
+                sum += term;
+            }
+            for (long i = 0; i < k; ++i) {
+                sum *= 2.;
+            }
+            for (long i = 0; i > k; --i) {
+                sum *= 0.5;
+            }
+            return sum;
+        }
+    }// namespace detail
+
+    template <std::floating_point T>
+    constexpr T constexpr_pow(T base, T exponent) {
+        if (not std::is_constant_evaluated()) {
+            return std::pow(base, exponent);
+        }
+        if (exponent == T(0)) {
+            return T(1);
+        } else if (base <= T(0)) {
+            return T(0);
+        }
+        return T(detail::constexpr_exp(double(exponent) * detail::constexpr_log(double(base))));
+    }
+
 }// namespace neo
 
 #endif//LIBNEON_MATH_HPP
@@ -0,0 +1,116 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_OKLAB_HPP
+#define LIBNEON_OKLAB_HPP
+
+#include <array>
+#include <neo/color.hpp>
+
+namespace neo {
+
+    /**
+     * Cube root via an initial guess on the float representation, refined with two Newton iterations.
+     * Relative error below 1e-6 for positive normal numbers; returns 0 for `x <= 0`.
+     */
+    [[nodiscard]] float fast_cbrt(float x);
+
+    /**
+     * Color in the [Oklab](https://bottosson.github.io/posts/oklab/) perceptual color space.
+     * Interpolating in Oklab avoids the dull midpoints of linear blending between complementary colors.
+     * Conversion from sRGB uses @ref fast_cbrt; conversion back to sRGB requires only multiplications, and then goes
+     * through @ref srgb_linear_table, so neither direction calls `std::pow` or `std::cbrt`.
+     */
+    struct oklab {
+        float l = 0.f;
+        float a = 0.f;
+        float b = 0.f;
+
+        constexpr oklab() = default;
+
+        constexpr oklab(float l_, float a_, float b_);
+
+        /**
+         * @param linear_rgb Linear RGB values in the range 0...1.
+         */
+        [[nodiscard]] static oklab from_linear(std::array<float, 3> const &linear_rgb);
+
+        explicit oklab(linear_rgb16 col);
+
+        explicit oklab(srgb col);
+
+        /**
+         * @return Linear RGB values, clamped in the range 0...1.
+         */
+        [[nodiscard]] std::array<float, 3> to_linear() const;
+
+        [[nodiscard]] linear_rgb16 to_linear_rgb16() const;
+
+        [[nodiscard]] srgb to_rgb() const;
+
+        [[nodiscard]] constexpr oklab lerp(oklab target, float t) const;
+    };
+
+    namespace blend_op {
+        /**
+         * Blends in @ref neo::oklab. The Oklab coordinates of the last pair of endpoints are cached, so sampling a
+         * gradient converts each pair of stops only once, and every pixel in between costs only the inverse transform.
+         * @note Because of the cache, an instance should not be shared between tasks.
+         */
+        class oklab {
+            // Black is (0, 0, 0) in Oklab too, so the default initialized cache is consistent
+            mutable srgb _l_key{};
+            mutable srgb _r_key{};
+            mutable neo::oklab _l{};
+            mutable neo::oklab _r{};
+
+            inline void update(srgb l, srgb r) const;
+
+        public:
+            [[nodiscard]] inline neo::oklab blend_oklab(srgb l, srgb r, float t) const;
+
+            [[nodiscard]] inline linear_rgb16 blend_to_linear(srgb l, srgb r, float t) const;
+
+            [[nodiscard]] inline srgb operator()(srgb l, srgb r, float t) const;
+        };
+    }// namespace blend_op
+
+}// namespace neo
+
+namespace neo {
+
+    constexpr oklab::oklab(float l_, float a_, float b_) : l{l_}, a{a_}, b{b_} {}
+
+    constexpr oklab oklab::lerp(oklab target, float t) const {
+        t = std::clamp(t, 0.f, 1.f);
+        return {l + (target.l - l) * t, a + (target.a - a) * t, b + (target.b - b) * t};
+    }
+
+    void blend_op::oklab::update(srgb l, srgb r) const {
+        if (l != _l_key) {
+            _l_key = l;
+            _l = neo::oklab{l};
+        }
+        if (r != _r_key) {
+            _r_key = r;
+            _r = neo::oklab{r};
+        }
+    }
+
+    neo::oklab blend_op::oklab::blend_oklab(srgb l, srgb r, float t) const {
+        update(l, r);
+        return _l.lerp(_r, t);
+    }
+
+    linear_rgb16 blend_op::oklab::blend_to_linear(srgb l, srgb r, float t) const {
+        return blend_oklab(l, r, t).to_linear_rgb16();
+    }
+
+    srgb blend_op::oklab::operator()(srgb l, srgb r, float t) const {
+        return blend_oklab(l, r, t).to_rgb();
+    }
+
+}// namespace neo
+
+#endif//LIBNEON_OKLAB_HPP
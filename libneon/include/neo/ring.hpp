@@ -0,0 +1,145 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_RING_HPP
+#define LIBNEON_RING_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+namespace neo {
+
+    /**
+     * Fixed-capacity FIFO queue for one producer task and one consumer task, without locks nor allocations.
+     * @tparam N Capacity, must be a power of two.
+     */
+    template <class T, std::size_t N>
+    class spsc_ring {
+        static_assert(N > 0 and (N & (N - 1)) == 0, "The capacity must be a power of two.");
+
+        std::array<T, N> _slots{};
+        /**
+         * Monotonic counters, the slot index is obtained by masking.
+         */
+        std::atomic<std::size_t> _head = 0;
+        std::atomic<std::size_t> _tail = 0;
+
+    public:
+        spsc_ring() = default;
+
+        /**
+         * Copies and moves transfer the queued items; they are only valid while no other task uses either ring.
+         */
+        spsc_ring(spsc_ring const &other);
+        spsc_ring(spsc_ring &&other) noexcept;
+        spsc_ring &operator=(spsc_ring const &other);
+        spsc_ring &operator=(spsc_ring &&other) noexcept;
+
+        [[nodiscard]] static constexpr std::size_t capacity();
+
+        /**
+         * Called by the producer only.
+         * @return False if the ring is full, in which case `item` is not consumed.
+         */
+        bool push(T &&item);
+
+        /**
+         * Called by the consumer only.
+         */
+        [[nodiscard]] std::optional<T> pop();
+
+        /**
+         * Called by the consumer only. Calls `fn` on each queued item, oldest first, without removing them.
+         */
+        template <class Fn>
+        void for_each(Fn &&fn) const;
+
+        [[nodiscard]] bool empty() const;
+    };
+
+}// namespace neo
+
+namespace neo {
+
+    template <class T, std::size_t N>
+    spsc_ring<T, N>::spsc_ring(spsc_ring const &other) : spsc_ring{} {
+        *this = other;
+    }
+
+    template <class T, std::size_t N>
+    spsc_ring<T, N>::spsc_ring(spsc_ring &&other) noexcept : spsc_ring{} {
+        *this = std::move(other);
+    }
+
+    template <class T, std::size_t N>
+    spsc_ring<T, N> &spsc_ring<T, N>::operator=(spsc_ring const &other) {
+        if (this != &other) {
+            while (pop()) {
+            }
+            other.for_each([&](T const &item) { push(T{item}); });
+        }
+        return *this;
+    }
+
+    template <class T, std::size_t N>
+    spsc_ring<T, N> &spsc_ring<T, N>::operator=(spsc_ring &&other) noexcept {
+        if (this != &other) {
+            while (pop()) {
+            }
+            while (std::optional<T> item = other.pop()) {
+                push(std::move(*item));
+            }
+        }
+        return *this;
+    }
+
+    template <class T, std::size_t N>
+    constexpr std::size_t spsc_ring<T, N>::capacity() {
+        return N;
+    }
+
+    template <class T, std::size_t N>
+    bool spsc_ring<T, N>::push(T &&item) {
+        const std::size_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _head.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        _slots[tail & (N - 1)] = std::move(item);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <class T, std::size_t N>
+    std::optional<T> spsc_ring<T, N>::pop() {
+        const std::size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+        std::optional<T> item{std::move(_slots[head & (N - 1)])};
+        // Do not keep a moved-from object alive in the ring longer than needed
+        _slots[head & (N - 1)] = T{};
+        _head.store(head + 1, std::memory_order_release);
+        return item;
+    }
+
+    template <class T, std::size_t N>
+    template <class Fn>
+    void spsc_ring<T, N>::for_each(Fn &&fn) const {
+        // The producer does not touch the slots between head and tail, and the consumer is the caller
+        const std::size_t tail = _tail.load(std::memory_order_acquire);
+        for (std::size_t i = _head.load(std::memory_order_relaxed); i != tail; ++i) {
+            fn(_slots[i & (N - 1)]);
+        }
+    }
+
+    template <class T, std::size_t N>
+    bool spsc_ring<T, N>::empty() const {
+        return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire);
+    }
+
+}// namespace neo
+
+#endif//LIBNEON_RING_HPP
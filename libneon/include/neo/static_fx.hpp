@@ -0,0 +1,360 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_STATIC_FX_HPP
+#define LIBNEON_STATIC_FX_HPP
+
+#include <neo/fx.hpp>
+
+/**
+ * Effects composed at compile time. Unlike @ref fx_base, nodes are held by value and render one pixel at a time: each
+ * frame, @ref effect::prepare is called once on the whole tree, then @ref effect::sample is called once per pixel on the
+ * root, which samples its children in turn. Since the whole tree is a single type, the compiler can inline it into one
+ * loop, without virtual calls, `std::shared_ptr` nor intermediate buffers.
+ *
+ * Use @ref adapter (or @ref make_fx) to turn a tree into a @ref fx_base, e.g. for @ref fx_base::make_callback:
+ * @code
+ * auto fx = neo::static_fx::make_fx(neo::static_fx::pulse{
+ *         neo::static_fx::solid{0x0_rgb},
+ *         neo::static_fx::gradient{std::vector<neo::srgb>{0xff0000_rgb, 0x0000ff_rgb}}, 4s});
+ * @endcode
+ */
+namespace neo::static_fx {
+
+    /**
+     * `prepare(a, num_leds)` computes whatever is constant across the frame; `sample(i)` returns the `i`-th pixel, and
+     * must not modify the effect. Effects can also implement `stable_until(a)`, with the same meaning as
+     * @ref fx_base::stable_until; without it, the output is assumed to change at every frame.
+     */
+    template <class Fx>
+    concept effect = requires(Fx &fx, Fx const &cfx, alarm const &a, std::size_t i) {
+        fx.prepare(a, i);
+        { cfx.sample(i) } -> std::convertible_to<linear_rgb16>;
+    };
+
+    /**
+     * Same as @ref solid_fx.
+     */
+    struct solid {
+        srgb color = {};
+
+        solid() = default;
+        inline explicit solid(srgb color_);
+
+        inline void prepare(alarm const &, std::size_t);
+        [[nodiscard]] inline linear_rgb16 sample(std::size_t) const;
+        [[nodiscard]] inline std::chrono::milliseconds stable_until(alarm const &) const;
+
+    private:
+        linear_rgb16 _color{};
+    };
+
+    /**
+     * Same as @ref gradient_fx. The gradient is baked in @ref prepare whenever it changes.
+     */
+    struct gradient {
+        std::vector<gradient_entry> entries = {};
+        std::chrono::milliseconds rotate_cycle_time = 0ms;
+        float scale = 1.f;
+        gradient_mode mode = gradient_mode::linear;
+        bool interpolate = true;
+
+        gradient() = default;
+        inline explicit gradient(std::vector<gradient_entry> entries_, std::chrono::milliseconds rotate_cycle_time_ = 2s, float scale_ = 1.f, gradient_mode mode_ = gradient_mode::linear);
+        inline explicit gradient(std::vector<srgb> colors_, std::chrono::milliseconds rotate_cycle_time_ = 2s, float scale_ = 1.f, gradient_mode mode_ = gradient_mode::linear);
+
+        inline void prepare(alarm const &a, std::size_t num_leds);
+        [[nodiscard]] inline linear_rgb16 sample(std::size_t i) const;
+        [[nodiscard]] inline std::chrono::milliseconds stable_until(alarm const &a) const;
+
+    private:
+        gradient_texture _texture;
+        std::vector<gradient_entry> _baked_entries;
+        gradient_mode _baked_mode = gradient_mode::linear;
+        bool _baked = false;
+        std::uint32_t _phase = 0;
+        std::uint32_t _step = 0;
+    };
+
+    /**
+     * Same as @ref hue_rotate_fx.
+     */
+    struct hue_rotate {
+        std::chrono::milliseconds rotate_cycle_time = 0ms;
+        float scale = 1.f;
+        float saturation = 1.f;
+        float value = 1.f;
+
+        hue_rotate() = default;
+        inline explicit hue_rotate(std::chrono::milliseconds rotate_cycle_time_, float scale_ = 1.f, float saturation_ = 1.f, float value_ = 1.f);
+
+        inline void prepare(alarm const &a, std::size_t num_leds);
+        [[nodiscard]] inline linear_rgb16 sample(std::size_t i) const;
+        [[nodiscard]] inline std::chrono::milliseconds stable_until(alarm const &a) const;
+
+    private:
+        std::uint32_t _hue = 0;
+        std::uint32_t _step = 0;
+        std::uint16_t _s = 0;
+        std::uint16_t _v = 0;
+    };
+
+    /**
+     * Same as @ref pulse_fx.
+     */
+    template <effect Lo, effect Hi>
+    struct pulse {
+        Lo lo;
+        Hi hi;
+        std::chrono::milliseconds cycle_time = 0ms;
+
+        pulse(Lo lo_, Hi hi_, std::chrono::milliseconds cycle_time_ = 2s);
+
+        void prepare(alarm const &a, std::size_t num_leds);
+        [[nodiscard]] linear_rgb16 sample(std::size_t i) const;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const;
+
+    private:
+        std::uint32_t _weight = 0;
+    };
+
+    /**
+     * Same as @ref blend_fx.
+     */
+    template <effect Lo, effect Hi>
+    struct blend {
+        Lo lo;
+        Hi hi;
+        float blend_factor = 0.5f;
+
+        blend(Lo lo_, Hi hi_, float blend_factor_ = 0.5f);
+
+        void prepare(alarm const &a, std::size_t num_leds);
+        [[nodiscard]] linear_rgb16 sample(std::size_t i) const;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const;
+
+    private:
+        std::uint32_t _weight = 0;
+    };
+
+    /**
+     * A @ref fx_base that renders a static effect tree in a single pass. It needs no scratch buffers.
+     */
+    template <effect Fx>
+    struct adapter : fx_base {
+        Fx fx;
+
+        explicit adapter(Fx fx_);
+
+        /**
+         * @note Flattened, so that the whole tree is inlined into the loop even when it exceeds the inlining heuristics.
+         */
+        [[gnu::flatten]] void populate(alarm const &a, color_range colors) override;
+        [[gnu::flatten]] void populate_linear(alarm const &a, linear_color_range colors) override;
+        [[nodiscard]] std::size_t scratch_depth() const override;
+        [[nodiscard]] std::chrono::milliseconds stable_until(alarm const &a) const override;
+        void prepare(alarm const &a, std::size_t num_leds) override;
+        /**
+         * Always true, since `sample` cannot modify the effect (see @ref effect).
+         */
+        [[nodiscard]] bool tile_safe() const override;
+        [[gnu::flatten]] void populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const override;
+    };
+
+    template <effect Fx>
+    [[nodiscard]] std::shared_ptr<fx_base> make_fx(Fx fx);
+
+    /**
+     * @return `fx.stable_until(a)` if it exists, otherwise `a.total_elapsed()`.
+     */
+    template <effect Fx>
+    [[nodiscard]] std::chrono::milliseconds stable_until(Fx const &fx, alarm const &a);
+
+}// namespace neo::static_fx
+
+namespace neo::static_fx {
+
+    solid::solid(srgb color_) : color{color_} {}
+
+    void solid::prepare(alarm const &, std::size_t) {
+        _color = linear_rgb16{color};
+    }
+
+    linear_rgb16 solid::sample(std::size_t) const {
+        return _color;
+    }
+
+    std::chrono::milliseconds solid::stable_until(alarm const &) const {
+        return fx_base::forever;
+    }
+
+    gradient::gradient(std::vector<gradient_entry> entries_, std::chrono::milliseconds rotate_cycle_time_, float scale_, gradient_mode mode_)
+        : entries{std::move(entries_)},
+          rotate_cycle_time{rotate_cycle_time_},
+          scale{scale_},
+          mode{mode_} {}
+
+    gradient::gradient(std::vector<srgb> colors_, std::chrono::milliseconds rotate_cycle_time_, float scale_, gradient_mode mode_)
+        : entries{neo::gradient_make_uniform_from_colors(std::move(colors_))},
+          rotate_cycle_time{rotate_cycle_time_},
+          scale{scale_},
+          mode{mode_} {}
+
+    void gradient::prepare(alarm const &a, std::size_t num_leds) {
+        if (not _baked or mode != _baked_mode or entries != _baked_entries) {
+            _texture.bake(entries, mode);
+            _baked_entries = entries;
+            _baked_mode = mode;
+            _baked = true;
+        }
+        // Same as gradient_texture::sample
+        const float rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
+        _phase = unit_to_phase(scale * rotation);
+        _step = num_leds > 0 ? unit_to_phase(scale / float(num_leds)) : 0;
+    }
+
+    linear_rgb16 gradient::sample(std::size_t i) const {
+        return _texture.texel_at(_phase + std::uint32_t(i) * _step, interpolate);
+    }
+
+    std::chrono::milliseconds gradient::stable_until(alarm const &a) const {
+        return rotate_cycle_time > 0ms ? a.total_elapsed() : fx_base::forever;
+    }
+
+    hue_rotate::hue_rotate(std::chrono::milliseconds rotate_cycle_time_, float scale_, float saturation_, float value_)
+        : rotate_cycle_time{rotate_cycle_time_},
+          scale{scale_},
+          saturation{saturation_},
+          value{value_} {}
+
+    void hue_rotate::prepare(alarm const &a, std::size_t num_leds) {
+        const float rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
+        _hue = unit_to_phase(rotation);
+        _step = num_leds > 0 ? unit_to_phase(scale / float(num_leds)) : 0;
+        _s = unit_to_u16(saturation);
+        _v = unit_to_u16(value);
+    }
+
+    linear_rgb16 hue_rotate::sample(std::size_t i) const {
+        return hsv16{std::uint16_t((_hue + std::uint32_t(i) * _step) >> 16), _s, _v}.to_linear();
+    }
+
+    std::chrono::milliseconds hue_rotate::stable_until(alarm const &a) const {
+        return rotate_cycle_time > 0ms ? a.total_elapsed() : fx_base::forever;
+    }
+
+    template <effect Lo, effect Hi>
+    pulse<Lo, Hi>::pulse(Lo lo_, Hi hi_, std::chrono::milliseconds cycle_time_)
+        : lo{std::move(lo_)}, hi{std::move(hi_)}, cycle_time{cycle_time_} {}
+
+    template <effect Lo, effect Hi>
+    void pulse<Lo, Hi>::prepare(alarm const &a, std::size_t num_leds) {
+        lo.prepare(a, num_leds);
+        hi.prepare(a, num_leds);
+        float t = cycle_time > 0ms ? a.cycle_time(cycle_time) : 0.f;
+        // Cycle is really half of it
+        t = 1.f - 2.f * std::abs(t - 0.5f);
+        _weight = unit_to_fixed(t);
+    }
+
+    template <effect Lo, effect Hi>
+    linear_rgb16 pulse<Lo, Hi>::sample(std::size_t i) const {
+        return linear_rgb16{lo.sample(i)}.blend_fixed(linear_rgb16{hi.sample(i)}, _weight);
+    }
+
+    template <effect Lo, effect Hi>
+    std::chrono::milliseconds pulse<Lo, Hi>::stable_until(alarm const &a) const {
+        if (cycle_time > 0ms) {
+            return a.total_elapsed();
+        }
+        return std::min(static_fx::stable_until(lo, a), static_fx::stable_until(hi, a));
+    }
+
+    template <effect Lo, effect Hi>
+    blend<Lo, Hi>::blend(Lo lo_, Hi hi_, float blend_factor_)
+        : lo{std::move(lo_)}, hi{std::move(hi_)}, blend_factor{blend_factor_} {}
+
+    template <effect Lo, effect Hi>
+    void blend<Lo, Hi>::prepare(alarm const &a, std::size_t num_leds) {
+        lo.prepare(a, num_leds);
+        hi.prepare(a, num_leds);
+        _weight = unit_to_fixed(blend_factor);
+    }
+
+    template <effect Lo, effect Hi>
+    linear_rgb16 blend<Lo, Hi>::sample(std::size_t i) const {
+        return linear_rgb16{lo.sample(i)}.blend_fixed(linear_rgb16{hi.sample(i)}, _weight);
+    }
+
+    template <effect Lo, effect Hi>
+    std::chrono::milliseconds blend<Lo, Hi>::stable_until(alarm const &a) const {
+        return std::min(static_fx::stable_until(lo, a), static_fx::stable_until(hi, a));
+    }
+
+    template <effect Fx>
+    adapter<Fx>::adapter(Fx fx_) : fx{std::move(fx_)} {}
+
+    template <effect Fx>
+    void adapter<Fx>::populate(alarm const &a, color_range colors) {
+        fx.prepare(a, colors.size());
+        std::size_t i = 0;
+        for (srgb &c : colors) {
+            c = linear_rgb16{fx.sample(i++)}.to_srgb();
+        }
+    }
+
+    template <effect Fx>
+    void adapter<Fx>::populate_linear(alarm const &a, linear_color_range colors) {
+        fx.prepare(a, colors.size());
+        std::size_t i = 0;
+        for (linear_rgb16 &c : colors) {
+            c = fx.sample(i++);
+        }
+    }
+
+    template <effect Fx>
+    std::size_t adapter<Fx>::scratch_depth() const {
+        return 0;
+    }
+
+    template <effect Fx>
+    std::chrono::milliseconds adapter<Fx>::stable_until(alarm const &a) const {
+        return static_fx::stable_until(fx, a);
+    }
+
+    template <effect Fx>
+    void adapter<Fx>::prepare(alarm const &a, std::size_t num_leds) {
+        fx.prepare(a, num_leds);
+    }
+
+    template <effect Fx>
+    bool adapter<Fx>::tile_safe() const {
+        return true;
+    }
+
+    template <effect Fx>
+    void adapter<Fx>::populate_tile(linear_color_range tile, std::size_t offset, std::size_t) const {
+        std::size_t i = offset;
+        for (linear_rgb16 &c : tile) {
+            c = fx.sample(i++);
+        }
+    }
+
+    template <effect Fx>
+    std::chrono::milliseconds stable_until(Fx const &fx, alarm const &a) {
+        if constexpr (requires { fx.stable_until(a); }) {
+            return fx.stable_until(a);
+        } else {
+            return a.total_elapsed();
+        }
+    }
+
+    template <effect Fx>
+    std::shared_ptr<fx_base> make_fx(Fx fx) {
+        return std::make_shared<adapter<Fx>>(std::move(fx));
+    }
+
+}// namespace neo::static_fx
+
+#endif//LIBNEON_STATIC_FX_HPP
@@ -0,0 +1,229 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#ifndef LIBNEON_TRACKED_BUFFER_HPP
+#define LIBNEON_TRACKED_BUFFER_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <ranges>
+#include <vector>
+
+namespace neo {
+
+    /**
+     * Half-open range of indices `[first, last)`.
+     */
+    struct index_span {
+        std::size_t first = 0;
+        std::size_t last = 0;
+
+        [[nodiscard]] constexpr std::size_t size() const;
+
+        constexpr bool operator==(index_span const &) const = default;
+    };
+
+    /**
+     * A buffer of colors that records which indices were written since the last call to @ref clear_dirty.
+     * Pass it to @ref led_encoder::transmit to extract only the changed pixels into the encoder's persistent buffer,
+     * so that the cost of a frame scales with the number of pixels that changed rather than with the strip length.
+     *
+     * Dirty indices are kept as a sorted list of disjoint spans, merging adjacent or overlapping ones. When there are
+     * more than @ref max_spans, they are collapsed into a single span covering all of them.
+     * @note The buffer is entirely dirty after construction and after @ref resize.
+     */
+    template <class Color>
+    class tracked_buffer {
+    public:
+        using range_t = std::ranges::subrange<typename std::vector<Color>::iterator>;
+        using const_range_t = std::ranges::subrange<typename std::vector<Color>::const_iterator>;
+
+        static constexpr std::size_t max_spans = 16;
+
+        tracked_buffer() = default;
+        explicit tracked_buffer(std::size_t n, Color fill_col = {});
+
+        [[nodiscard]] std::size_t size() const;
+
+        /**
+         * Resizes the buffer and marks it all dirty.
+         */
+        void resize(std::size_t n, Color fill_col = {});
+
+        [[nodiscard]] Color const &operator[](std::size_t i) const;
+
+        /**
+         * Sets the `i`-th color, marking it dirty only if it changed.
+         */
+        void set(std::size_t i, Color col);
+
+        /**
+         * Sets all colors in `[first, last)`, marking them dirty.
+         */
+        void fill(std::size_t first, std::size_t last, Color col);
+
+        /**
+         * @return The colors in `[first, last)` for writing, marked dirty.
+         */
+        [[nodiscard]] range_t write(std::size_t first, std::size_t last);
+
+        /**
+         * Copies `colors` into the buffer, starting at `first`, and marks dirty the spans that actually changed.
+         * Comparing is cheaper than extracting, so this is worthwhile to feed the output of a whole frame.
+         */
+        template <std::ranges::input_range Range>
+        void assign(Range const &colors, std::size_t first = 0);
+
+        [[nodiscard]] const_range_t colors() const;
+
+        void mark_dirty(std::size_t first, std::size_t last);
+        void mark_all_dirty();
+
+        [[nodiscard]] std::vector<index_span> const &dirty_spans() const;
+
+        /**
+         * @return The number of dirty indices.
+         */
+        [[nodiscard]] std::size_t dirty_count() const;
+
+        void clear_dirty();
+
+    private:
+        std::vector<Color> _colors;
+        std::vector<index_span> _dirty;
+    };
+
+}// namespace neo
+
+namespace neo {
+
+    constexpr std::size_t index_span::size() const {
+        return last - first;
+    }
+
+    template <class Color>
+    tracked_buffer<Color>::tracked_buffer(std::size_t n, Color fill_col) {
+        resize(n, fill_col);
+    }
+
+    template <class Color>
+    std::size_t tracked_buffer<Color>::size() const {
+        return _colors.size();
+    }
+
+    template <class Color>
+    void tracked_buffer<Color>::resize(std::size_t n, Color fill_col) {
+        _colors.resize(n, fill_col);
+        mark_all_dirty();
+    }
+
+    template <class Color>
+    Color const &tracked_buffer<Color>::operator[](std::size_t i) const {
+        return _colors[i];
+    }
+
+    template <class Color>
+    void tracked_buffer<Color>::set(std::size_t i, Color col) {
+        if (_colors[i] != col) {
+            _colors[i] = col;
+            mark_dirty(i, i + 1);
+        }
+    }
+
+    template <class Color>
+    void tracked_buffer<Color>::fill(std::size_t first, std::size_t last, Color col) {
+        last = std::min(last, size());
+        if (first < last) {
+            std::fill(std::next(std::begin(_colors), std::ptrdiff_t(first)), std::next(std::begin(_colors), std::ptrdiff_t(last)), col);
+            mark_dirty(first, last);
+        }
+    }
+
+    template <class Color>
+    typename tracked_buffer<Color>::range_t tracked_buffer<Color>::write(std::size_t first, std::size_t last) {
+        last = std::min(last, size());
+        first = std::min(first, last);
+        mark_dirty(first, last);
+        return {std::next(std::begin(_colors), std::ptrdiff_t(first)), std::next(std::begin(_colors), std::ptrdiff_t(last))};
+    }
+
+    template <class Color>
+    template <std::ranges::input_range Range>
+    void tracked_buffer<Color>::assign(Range const &colors, std::size_t first) {
+        std::size_t i = first;
+        std::size_t changed_from = size();
+        for (auto const &col : colors) {
+            if (i >= size()) {
+                break;
+            }
+            if (_colors[i] != col) {
+                _colors[i] = col;
+                changed_from = std::min(changed_from, i);
+            } else if (changed_from < i) {
+                mark_dirty(changed_from, i);
+                changed_from = size();
+            }
+            ++i;
+        }
+        if (changed_from < i) {
+            mark_dirty(changed_from, i);
+        }
+    }
+
+    template <class Color>
+    typename tracked_buffer<Color>::const_range_t tracked_buffer<Color>::colors() const {
+        return {std::begin(_colors), std::end(_colors)};
+    }
+
+    template <class Color>
+    void tracked_buffer<Color>::mark_dirty(std::size_t first, std::size_t last) {
+        if (first >= last) {
+            return;
+        }
+        // First span that is not entirely before [first, last), adjacent ones included
+        auto it = std::lower_bound(std::begin(_dirty), std::end(_dirty), first,
+                                   [](index_span const &s, std::size_t i) { return s.last < i; });
+        index_span merged{first, last};
+        auto end = it;
+        while (end != std::end(_dirty) and end->first <= last) {
+            merged.first = std::min(merged.first, end->first);
+            merged.last = std::max(merged.last, end->last);
+            ++end;
+        }
+        it = _dirty.erase(it, end);
+        _dirty.insert(it, merged);
+        if (_dirty.size() > max_spans) {
+            const index_span all{_dirty.front().first, _dirty.back().last};
+            _dirty.assign(1, all);
+        }
+    }
+
+    template <class Color>
+    void tracked_buffer<Color>::mark_all_dirty() {
+        _dirty.clear();
+        mark_dirty(0, size());
+    }
+
+    template <class Color>
+    std::vector<index_span> const &tracked_buffer<Color>::dirty_spans() const {
+        return _dirty;
+    }
+
+    template <class Color>
+    std::size_t tracked_buffer<Color>::dirty_count() const {
+        std::size_t n = 0;
+        for (index_span const &s : _dirty) {
+            n += s.size();
+        }
+        return n;
+    }
+
+    template <class Color>
+    void tracked_buffer<Color>::clear_dirty() {
+        _dirty.clear();
+    }
+
+}// namespace neo
+
+#endif//LIBNEON_TRACKED_BUFFER_HPP
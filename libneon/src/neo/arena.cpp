@@ -0,0 +1,62 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#include <neo/arena.hpp>
+
+namespace neo {
+
+    namespace {
+        thread_local frame_arena *_current_arena = nullptr;
+    }// namespace
+
+    frame_arena::scope::scope(frame_arena &arena) : _previous{_current_arena} {
+        _current_arena = &arena;
+    }
+
+    frame_arena::scope::~scope() {
+        _current_arena = _previous;
+    }
+
+    frame_arena &frame_arena::current() {
+        if (_current_arena != nullptr) {
+            return *_current_arena;
+        }
+        thread_local frame_arena _fallback{};
+        return _fallback;
+    }
+
+    template <class T>
+    void frame_arena::reserve_stack(std::size_t depth, std::size_t num_leds) {
+        stack<T> &s = stack_for<T>();
+        if (s.slots.size() < depth) {
+            s.slots.resize(depth);
+        }
+        for (std::size_t i = 0; i < depth; ++i) {
+            if (s.slots[i].size() < num_leds) {
+                s.slots[i].resize(num_leds);
+            }
+        }
+    }
+
+    void frame_arena::reserve(std::size_t depth, std::size_t num_leds) {
+        reserve_stack<linear_rgb16>(depth, num_leds);
+        reserve_stack<srgb>(depth, num_leds);
+    }
+
+    std::size_t frame_arena::peak_bytes() const {
+        return _peak_bytes;
+    }
+
+    std::size_t frame_arena::reserved_bytes() const {
+        std::size_t total = 0;
+        for (auto const &slot : _linear.slots) {
+            total += slot.size() * sizeof(linear_rgb16);
+        }
+        for (auto const &slot : _srgb.slots) {
+            total += slot.size() * sizeof(srgb);
+        }
+        return total;
+    }
+
+}// namespace neo
@@ -0,0 +1,134 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#include <cstring>
+#include <neo/blend.hpp>
+
+namespace neo {
+
+    namespace {
+        static_assert(sizeof(srgb) == 3, "Batch kernels assume that pixels are tightly packed.");
+
+        /**
+         * Native word of the target; on Xtensa and RISC-V this is 32 bits, 64 bits on most hosts.
+         */
+#if UINTPTR_MAX > 0xffffffffu
+        using swar_word_t = std::uint64_t;
+        constexpr swar_word_t swar_lane_mask = 0x00ff00ff00ff00ffull;
+#else
+        using swar_word_t = std::uint32_t;
+        constexpr swar_word_t swar_lane_mask = 0x00ff00ffu;
+#endif
+
+        /**
+         * @param w Weight in the range 0...0x100.
+         */
+        [[nodiscard]] constexpr std::uint8_t lerp_byte(std::uint8_t l, std::uint8_t r, std::uint32_t w) {
+            return std::uint8_t((std::uint32_t(l) * (0x100 - w) + std::uint32_t(r) * w + 0x80) >> 8);
+        }
+
+        /**
+         * Each byte is spread into a 16-bit lane, so that `l * (0x100 - w) + r * w + 0x80 <= 0xff80` never carries
+         * into the next lane. Even and odd bytes are processed separately.
+         */
+        [[nodiscard]] constexpr swar_word_t lerp_word(swar_word_t l, swar_word_t r, std::uint32_t w) {
+            constexpr swar_word_t rounding = (swar_lane_mask / 0xff) * 0x80;
+            const auto lerp_lanes = [&](swar_word_t l_lanes, swar_word_t r_lanes) -> swar_word_t {
+                return ((l_lanes * (0x100 - w) + r_lanes * w + rounding) >> 8) & swar_lane_mask;
+            };
+            const swar_word_t even = lerp_lanes(l & swar_lane_mask, r & swar_lane_mask);
+            const swar_word_t odd = lerp_lanes((l >> 8) & swar_lane_mask, (r >> 8) & swar_lane_mask);
+            return even | (odd << 8);
+        }
+    }// namespace
+
+    std::size_t blend_batch(std::span<const linear_rgb16> l, std::span<const linear_rgb16> r, std::span<linear_rgb16> out, float t) {
+        const std::size_t n = std::min({l.size(), r.size(), out.size()});
+        const std::uint32_t weight = unit_to_fixed(t);
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = l[i].blend_fixed(r[i], weight);
+        }
+        return n;
+    }
+
+    namespace {
+        /**
+         * Blends a constant color `c` with weight `c_weight` with each pixel of `px`. Same as @ref lerp_fixed, with the
+         * constant term (rounding included) computed once per channel.
+         */
+        std::size_t blend_constant(linear_rgb16 c, std::uint32_t c_weight, std::span<const linear_rgb16> px, std::span<linear_rgb16> out) {
+            const std::size_t n = std::min(px.size(), out.size());
+            const std::uint32_t px_weight = 0x10000 - c_weight;
+            const std::uint32_t cr = std::uint32_t(c.r) * c_weight + 0x8000;
+            const std::uint32_t cg = std::uint32_t(c.g) * c_weight + 0x8000;
+            const std::uint32_t cb = std::uint32_t(c.b) * c_weight + 0x8000;
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = {std::uint16_t((cr + std::uint32_t(px[i].r) * px_weight) >> 16),
+                          std::uint16_t((cg + std::uint32_t(px[i].g) * px_weight) >> 16),
+                          std::uint16_t((cb + std::uint32_t(px[i].b) * px_weight) >> 16)};
+            }
+            return n;
+        }
+    }// namespace
+
+    std::size_t blend_batch(linear_rgb16 l, std::span<const linear_rgb16> r, std::span<linear_rgb16> out, float t) {
+        return blend_constant(l, 0x10000 - unit_to_fixed(t), r, out);
+    }
+
+    std::size_t blend_batch(std::span<const linear_rgb16> l, linear_rgb16 r, std::span<linear_rgb16> out, float t) {
+        return blend_constant(r, unit_to_fixed(t), l, out);
+    }
+
+    void blend_op::linear_lut::batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t) {
+        auto const &lut = srgb_linear_table();
+        const std::uint32_t weight = unit_to_fixed(t);
+        for (std::size_t i = 0; i < out.size(); ++i) {
+            out[i] = lut.blend(l[i], r[i], weight);
+        }
+    }
+
+    void blend_op::lerp_fixed::batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t) {
+        // Same reduction as in srgb::lerp_fixed
+        const std::uint32_t w = (unit_to_fixed(t) + 0x80) >> 8;
+        auto const *l_bytes = reinterpret_cast<std::uint8_t const *>(l.data());
+        auto const *r_bytes = reinterpret_cast<std::uint8_t const *>(r.data());
+        auto *out_bytes = reinterpret_cast<std::uint8_t *>(out.data());
+        const std::size_t n_bytes = out.size_bytes();
+        std::size_t i = 0;
+        // Channels are blended independently, so the pixel boundaries do not matter
+        for (; i + sizeof(swar_word_t) <= n_bytes; i += sizeof(swar_word_t)) {
+            swar_word_t l_word{};
+            swar_word_t r_word{};
+            std::memcpy(&l_word, l_bytes + i, sizeof(swar_word_t));
+            std::memcpy(&r_word, r_bytes + i, sizeof(swar_word_t));
+            const swar_word_t out_word = lerp_word(l_word, r_word, w);
+            std::memcpy(out_bytes + i, &out_word, sizeof(swar_word_t));
+        }
+        for (; i < n_bytes; ++i) {
+            out_bytes[i] = lerp_byte(l_bytes[i], r_bytes[i], w);
+        }
+    }
+
+    void blend_op::round_down::batch(std::span<const srgb> l, std::span<const srgb>, std::span<srgb> out, float) {
+        if (l.data() != out.data()) {
+            std::memmove(out.data(), l.data(), out.size_bytes());
+        }
+    }
+
+    void blend_op::round_up::batch(std::span<const srgb>, std::span<const srgb> r, std::span<srgb> out, float) {
+        if (r.data() != out.data()) {
+            std::memmove(out.data(), r.data(), out.size_bytes());
+        }
+    }
+
+    void blend_op::nearest_neighbor::batch(std::span<const srgb> l, std::span<const srgb> r, std::span<srgb> out, float t) {
+        // The choice depends only on t, so it is the same for every pixel
+        if (picks_left(t)) {
+            round_down::batch(l, r, out, t);
+        } else {
+            round_up::batch(l, r, out, t);
+        }
+    }
+
+}// namespace neo
@@ -6,10 +6,21 @@
 
 namespace neo {
 
-    srgb_gamma_channel_extractor const &srgb_linear_channel_extractor() {
-        static srgb_gamma_channel_extractor _extractor{1.f};
-        return _extractor;
-    }
+    // The tables must be built entirely at compile time, so that they live in flash and need no initialization
+    static_assert(srgb_linear_channel_extractor().lut[0x00] == 0x00 and srgb_linear_channel_extractor().lut[0xff] == 0xff);
+    static_assert(srgb_linear_channel_extractor().lut[0x80] == 0x37, "sRGB 0x80 is ~21.6% in linear space.");
+    static_assert(srgb_gamma_extractor_v<2.2f>.lut[0x80] == 0x09);
+    static_assert(linear_channel_extractor().lut[0x80] == 0x7f80 and linear_channel_extractor().lut[0x100] == 0xff00);
+    static_assert(linear_gamma_extractor_v<2.2f>.lut[0x80] == 0x377f, "0.5^2.2 is ~0.2176.");
+    static_assert(srgb_linear_table().to_linear[0xff] == 0xffff);
+    static_assert([] {
+        for (std::uint16_t v = 0x00; v <= 0xff; ++v) {
+            if (srgb_linear_table().from_linear(srgb_linear_table().to_linear[v]) != v) {
+                return false;
+            }
+        }
+        return true;
+    }(), "srgb_linear_lut::from_linear must invert srgb_linear_lut::to_linear.");
 
     std::string srgb::to_string() const {
         // Do not use stringstream, it requires tons of memory
@@ -27,6 +38,10 @@ namespace neo {
                             to_linear(b) * (1.f - factor) + to_linear(target.b) * factor});
     }
 
+    srgb srgb::blend_fixed(srgb target, std::uint32_t weight) const {
+        return srgb_linear_table().blend(*this, target, weight);
+    }
+
     srgb srgb::lerp(srgb target, float factor) const {
         factor = std::clamp(factor, 0.f, 1.f);
         return {
@@ -91,6 +106,24 @@ namespace neo {
         }
     }
 
+    std::size_t convert_batch(std::span<const hsv16> in, std::span<linear_rgb16> out) {
+        const std::size_t n = std::min(in.size(), out.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = in[i].to_linear();
+        }
+        return n;
+    }
+
+    std::size_t convert_batch(std::span<const hsv16> in, std::span<srgb> out) {
+        auto const &lut = srgb_linear_table();
+        const std::size_t n = std::min(in.size(), out.size());
+        for (std::size_t i = 0; i < n; ++i) {
+            const linear_rgb16 c = in[i].to_linear();
+            out[i] = {lut.from_linear(c.r), lut.from_linear(c.g), lut.from_linear(c.b)};
+        }
+        return n;
+    }
+
     hsv hsv::clamped() const {
         return {
                 modclamp(h),
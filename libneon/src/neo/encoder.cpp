@@ -3,16 +3,206 @@
 //
 
 #include <driver/rmt_tx.h>
+#include <esp_attr.h>
 #include <esp_log.h>
+#include <freertos/task.h>
 #include <neo/encoder.hpp>
+#include <neo/math.hpp>
 
 namespace neo {
 
     namespace {
         constexpr rmt_copy_encoder_config_t rmt_copy_encoder_config{};
         constexpr rmt_transmit_config_t rmt_transmit_config{.loop_count = 0, .flags = {.eot_level = 0}};
+
+        [[nodiscard]] TickType_t to_ticks(std::chrono::milliseconds timeout) {
+            if (timeout >= led_encoder::wait_forever / 2) {
+                return portMAX_DELAY;
+            }
+            return pdMS_TO_TICKS(std::max(timeout, 0ms).count());
+        }
+
+        /**
+         * Blocks on `sem` until `is_done` returns true. `sem` must be given after each change that may affect `is_done`.
+         */
+        template <class Predicate>
+        esp_err_t wait_until(SemaphoreHandle_t sem, Predicate &&is_done, std::chrono::milliseconds timeout) {
+            const TickType_t timeout_ticks = to_ticks(timeout);
+            const TickType_t start = xTaskGetTickCount();
+            while (not is_done()) {
+                TickType_t remaining = portMAX_DELAY;
+                if (timeout_ticks != portMAX_DELAY) {
+                    const TickType_t elapsed = xTaskGetTickCount() - start;
+                    if (elapsed >= timeout_ticks) {
+                        return ESP_ERR_TIMEOUT;
+                    }
+                    remaining = timeout_ticks - elapsed;
+                }
+                // A give may be left over from an earlier change, so check again
+                xSemaphoreTake(sem, remaining);
+            }
+            return ESP_OK;
+        }
+
+        [[nodiscard]] std::uint32_t fnv1a_hash(const_byte_range data) {
+            std::uint32_t hash = 2166136261u;
+            for (std::uint8_t const b : data) {
+                hash = (hash ^ b) * 16777619u;
+            }
+            return hash;
+        }
+
+        /**
+         * True if `frame` does not come after `done`, even across a wraparound.
+         */
+        [[nodiscard]] constexpr bool frame_done(std::uint32_t done, std::uint32_t frame) {
+            return std::int32_t(done - frame) >= 0;
+        }
     }// namespace
 
+    led_encoder::tx_sync::tx_sync() : done_sem{xSemaphoreCreateBinary()} {
+        if (done_sem == nullptr) {
+            ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+        }
+    }
+
+    led_encoder::tx_sync::~tx_sync() {
+        vSemaphoreDelete(done_sem);
+    }
+
+    bool IRAM_ATTR led_encoder::_on_trans_done(rmt_channel_handle_t, const rmt_tx_done_event_data_t *, void *user_ctx) {
+        auto &sync = *reinterpret_cast<tx_sync *>(user_ctx);
+        // Frames on a channel complete in the order they are queued
+        const std::uint32_t frame = sync.done_frames.fetch_add(1, std::memory_order_acq_rel) + 1;
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(sync.done_sem, &woken);
+        bool user_woken = false;
+        if (transmit_done_fn const fn = sync.on_done; fn != nullptr) {
+            user_woken = fn(frame, sync.on_done_ctx);
+        }
+        return woken == pdTRUE or user_woken;
+    }
+
+    std::size_t direct_frame::symbols_per_led() const {
+        return 8 * chn_seq.size();
+    }
+
+    std::size_t IRAM_ATTR direct_frame::encode(std::size_t symbols_written, std::size_t symbols_free, rmt_symbol_word_t *symbols, bool &done) const {
+        const std::size_t led_symbols = symbols_per_led();
+        const std::size_t total_symbols = num_leds * led_symbols;
+        std::size_t written = 0;
+        if (symbols_written < total_symbols) {
+            // Only whole LEDs are written, so symbols_written is always at a LED boundary
+            const std::size_t first_led = symbols_written / led_symbols;
+            const std::size_t n = std::min(num_leds - first_led, symbols_free / led_symbols);
+            fill(*this, first_led, n, symbols);
+            written = n * led_symbols;
+        }
+        if (symbols_written + written == total_symbols and written < symbols_free) {
+            symbols[written++] = reset_sym;
+            done = true;
+        }
+        return written;
+    }
+
+    stream_frame::stream_frame() : consumed_sem{xSemaphoreCreateBinary()} {
+        if (consumed_sem == nullptr) {
+            ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+        }
+    }
+
+    stream_frame::~stream_frame() {
+        vSemaphoreDelete(consumed_sem);
+    }
+
+    std::size_t stream_frame::num_chunks() const {
+        return (format.num_leds + chunk_leds - 1) / chunk_leds;
+    }
+
+    std::size_t stream_frame::slot_offset(std::size_t chunk) const {
+        return (chunk % num_slots) * chunk_leds;
+    }
+
+    esp_err_t stream_frame::wait_slot(std::size_t chunk, std::chrono::milliseconds timeout) {
+        return wait_until(
+                consumed_sem, [&] { return chunk < consumed_chunks.load(std::memory_order_acquire) + num_slots; }, timeout);
+    }
+
+    void stream_frame::publish_chunk() {
+        published_chunks.fetch_add(1, std::memory_order_release);
+    }
+
+    void stream_frame::restart() {
+        published_chunks.store(0, std::memory_order_relaxed);
+        consumed_chunks.store(0, std::memory_order_relaxed);
+        // Drop a give left over from the previous frame
+        xSemaphoreTake(consumed_sem, 0);
+    }
+
+    std::size_t IRAM_ATTR stream_frame::encode(std::size_t symbols_written, std::size_t symbols_free, rmt_symbol_word_t *symbols, bool &done) {
+        const std::size_t led_symbols = format.symbols_per_led();
+        const std::size_t total_symbols = format.num_leds * led_symbols;
+        const std::size_t published = published_chunks.load(std::memory_order_acquire);
+        std::size_t written = 0;
+        bool freed_slot = false;
+        while (symbols_written + written < total_symbols and symbols_free - written >= led_symbols) {
+            const std::size_t led = (symbols_written + written) / led_symbols;
+            const std::size_t chunk = led / chunk_leds;
+            const std::size_t chunk_end = std::min((chunk + 1) * chunk_leds, format.num_leds);
+            const std::size_t n = std::min(chunk_end - led, (symbols_free - written) / led_symbols);
+            if (chunk < published) {
+                format.fill(format, slot_offset(chunk) + led % chunk_leds, n, symbols + written);
+            } else {
+                // Keep the timing of the frame, the strip would latch early otherwise
+                for (std::size_t i = 0; i < n * format.chn_seq.size(); ++i) {
+                    format.encode_byte(0, symbols + written + 8 * i);
+                }
+                underrun_leds.fetch_add(n, std::memory_order_relaxed);
+            }
+            written += n * led_symbols;
+            if (led + n == chunk_end) {
+                consumed_chunks.store(chunk + 1, std::memory_order_release);
+                freed_slot = true;
+            }
+        }
+        if (freed_slot) {
+            // The first refill happens in rmt_transmit, the others in the RMT interrupt
+            if (xPortInIsrContext()) {
+                BaseType_t woken = pdFALSE;
+                xSemaphoreGiveFromISR(consumed_sem, &woken);
+                if (woken == pdTRUE) {
+                    portYIELD_FROM_ISR();
+                }
+            } else {
+                xSemaphoreGive(consumed_sem);
+            }
+        }
+        if (symbols_written + written == total_symbols and written < symbols_free) {
+            symbols[written++] = format.reset_sym;
+            done = true;
+        }
+        return written;
+    }
+
+    std::size_t IRAM_ATTR led_encoder::_encode_stream(const void *data, std::size_t, std::size_t symbols_written, std::size_t symbols_free,
+                                                      rmt_symbol_word_t *symbols, bool *done, void *) {
+        // The frame is only borrowed, rmt_transmit takes a pointer to const
+        return static_cast<stream_frame *>(const_cast<void *>(data))->encode(symbols_written, symbols_free, symbols, *done);
+    }
+
+    std::size_t IRAM_ATTR led_encoder::_encode_direct(const void *data, std::size_t, std::size_t symbols_written, std::size_t symbols_free,
+                                                      rmt_symbol_word_t *symbols, bool *done, void *) {
+        return static_cast<direct_frame const *>(data)->encode(symbols_written, symbols_free, symbols, *done);
+    }
+
+    esp_err_t led_encoder::queue(rmt_encoder_handle_t encoder, void const *data, std::size_t size) {
+        if (auto const r = rmt_transmit(_rmt_chn, encoder, data, size, &rmt_transmit_config); r != ESP_OK) {
+            return r;
+        }
+        ++_submitted_frames;
+        return ESP_OK;
+    }
+
     esp_err_t led_encoder::transmit_raw(const_byte_range data) {
         if (_rmt_chn == nullptr) {
             return ESP_ERR_INVALID_STATE;
@@ -21,7 +211,214 @@ namespace neo {
             ESP_LOGW("NEO", "You are transmitting empty color data.");
             return ESP_OK;
         }
-        return rmt_transmit(_rmt_chn, this, data.data(), data.size(), &rmt_transmit_config);
+        if (_cache_cap > 0) {
+            return transmit_cached(data);
+        }
+        return queue(this, data.data(), data.size());
+    }
+
+    std::size_t led_encoder::cached_frame::memory() const {
+        return bytes.size() + symbols.size() * sizeof(rmt_symbol_word_t);
+    }
+
+    esp_err_t led_encoder::transmit_cached(const_byte_range data) {
+        const std::uint32_t hash = fnv1a_hash(data);
+        auto it = std::find_if(std::begin(_cache), std::end(_cache), [&](cached_frame const &entry) {
+            return entry.hash == hash and std::equal(std::begin(entry.bytes), std::end(entry.bytes), std::begin(data), std::end(data));
+        });
+        if (it != std::end(_cache)) {
+            ++_cache_hits;
+        } else {
+            ++_cache_misses;
+            const std::size_t num_bytes = data.size() + (8 * data.size() + 1) * sizeof(rmt_symbol_word_t);
+            if (_last_miss_hash != hash or not make_cache_room(num_bytes)) {
+                _last_miss_hash = hash;
+                return queue(this, data.data(), data.size());
+            }
+            _last_miss_hash = std::nullopt;
+            cached_frame &entry = _cache.emplace_back(cached_frame{.hash = hash, .bytes = {std::begin(data), std::end(data)}, .symbols = {}});
+            entry.symbols.resize(8 * data.size() + 1);
+            const direct_frame bits{.bit0 = _bits_cfg.bit0, .bit1 = _bits_cfg.bit1, .msb_first = bool(_bits_cfg.flags.msb_first)};
+            for (std::size_t i = 0; i < data.size(); ++i) {
+                bits.encode_byte(data[i], &entry.symbols[8 * i]);
+            }
+            entry.symbols.back() = _reset_sym;
+            it = std::prev(std::end(_cache));
+        }
+        if (auto const r = queue(_symbols_encoder, it->symbols.data(), it->symbols.size() * sizeof(rmt_symbol_word_t)); r != ESP_OK) {
+            return r;
+        }
+        it->frame = _submitted_frames;
+        return ESP_OK;
+    }
+
+    bool led_encoder::make_cache_room(std::size_t num_bytes) {
+        if (num_bytes > _cache_cap) {
+            return false;
+        }
+        std::size_t used = 0;
+        for (cached_frame const &entry : _cache) {
+            used += entry.memory();
+        }
+        while (used + num_bytes > _cache_cap) {
+            // Least recently used among those that are not being read by RMT
+            auto lru = std::end(_cache);
+            for (auto it = std::begin(_cache); it != std::end(_cache); ++it) {
+                if (is_done(it->frame) and (lru == std::end(_cache) or std::int32_t(it->frame - lru->frame) < 0)) {
+                    lru = it;
+                }
+            }
+            if (lru == std::end(_cache)) {
+                return false;
+            }
+            used -= lru->memory();
+            _cache.erase(lru);
+        }
+        return true;
+    }
+
+    void led_encoder::set_symbol_cache(std::size_t max_bytes) {
+        ESP_ERROR_CHECK(wait_all_done());
+        _cache_cap = max_bytes;
+        _last_miss_hash = std::nullopt;
+        // Nothing is being transmitted, so this always makes it fit
+        make_cache_room(0);
+        if (_cache_cap == 0) {
+            _cache.shrink_to_fit();
+        }
+    }
+
+    symbol_cache_stats led_encoder::cache_stats() const {
+        symbol_cache_stats stats{.hits = _cache_hits, .misses = _cache_misses, .num_entries = _cache.size(), .used_bytes = 0};
+        for (cached_frame const &entry : _cache) {
+            stats.used_bytes += entry.memory();
+        }
+        return stats;
+    }
+
+#if LIBNEON_DIRECT_TRANSMIT
+    esp_err_t led_encoder::transmit_stream(stream_frame &frame) {
+        if (_rmt_chn == nullptr) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (frame.format.num_leds == 0) {
+            ESP_LOGW("NEO", "You are transmitting empty color data.");
+            return ESP_OK;
+        }
+        return queue(_stream_encoder, &frame, sizeof(stream_frame));
+    }
+
+    esp_err_t led_encoder::submit_direct() {
+        if (_rmt_chn == nullptr) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        tx_buffer &buffer = _buffers[_last_buffer];
+        if (buffer.direct.num_leds == 0) {
+            ESP_LOGW("NEO", "You are transmitting empty color data.");
+            return ESP_OK;
+        }
+        const esp_err_t r = queue(_direct_encoder, &buffer.direct, sizeof(direct_frame));
+        buffer.frame = _submitted_frames;
+        return r;
+    }
+#endif
+
+    std::size_t led_encoder::next_buffer() const {
+        return (_last_buffer + 1) % _buffers.size();
+    }
+
+    led_encoder::tx_buffer &led_encoder::acquire_next() {
+        ESP_ERROR_CHECK(wait_free_buffer());
+        _tracked_source = nullptr;
+        _last_buffer = next_buffer();
+        return _buffers[_last_buffer];
+    }
+
+    std::span<std::uint8_t> led_encoder::acquire_buffer(std::size_t num_bytes) {
+        std::vector<std::uint8_t> &bytes = acquire_next().bytes;
+        bytes.resize(num_bytes);
+        return bytes;
+    }
+
+    esp_err_t led_encoder::submit_buffer() {
+        tx_buffer &buffer = _buffers[_last_buffer];
+        const esp_err_t r = transmit_raw({std::begin(buffer.bytes), std::end(buffer.bytes)});
+        // If nothing was queued, waiting for the previous frame is harmless
+        buffer.frame = _submitted_frames;
+        return r;
+    }
+
+    std::size_t led_encoder::num_buffers() const {
+        return _buffers.size();
+    }
+
+    std::uint32_t led_encoder::last_frame() const {
+        return _submitted_frames;
+    }
+
+    bool led_encoder::is_done(std::uint32_t frame) const {
+        if (_sync == nullptr) {
+            return true;
+        }
+        return frame_done(_sync->done_frames.load(std::memory_order_acquire), frame);
+    }
+
+    esp_err_t led_encoder::wait_done(std::uint32_t frame, std::chrono::milliseconds timeout) {
+        if (is_done(frame)) {
+            return ESP_OK;
+        }
+        return wait_until(
+                _sync->done_sem, [&] { return is_done(frame); }, timeout);
+    }
+
+    esp_err_t led_encoder::wait_all_done(std::chrono::milliseconds timeout) {
+        return wait_done(last_frame(), timeout);
+    }
+
+    esp_err_t led_encoder::wait_free_buffer(std::chrono::milliseconds timeout) {
+        return wait_done(_buffers[next_buffer()].frame, timeout);
+    }
+
+    void led_encoder::set_on_transmit_done(transmit_done_fn fn, void *user_ctx) {
+        if (_sync == nullptr) {
+            return;
+        }
+        _sync->on_done = fn;
+        _sync->on_done_ctx = user_ctx;
+    }
+
+    void led_encoder::set_budget(std::optional<power_budget> budget) {
+        _budget = budget;
+    }
+
+    std::optional<power_budget> const &led_encoder::budget() const {
+        return _budget;
+    }
+
+    frame_stats const &led_encoder::last_frame_stats() const {
+        return _stats;
+    }
+
+    void led_encoder::apply_budget(std::array<std::uint32_t, 3> const &channel_sums, std::size_t num_leds, std::span<std::uint8_t> buffer) {
+        assert(_budget);
+        const float idle_ma = _budget->idle_ma_per_led * float(num_leds);
+        float dynamic_ma = 0.f;
+        for (std::size_t i = 0; i < channel_sums.size(); ++i) {
+            dynamic_ma += _budget->ma_per_step[i] * float(channel_sums[i]);
+        }
+        _stats = {.num_leds = num_leds, .estimated_ma = idle_ma + dynamic_ma, .scale = 1.f, .limited_ma = idle_ma + dynamic_ma};
+        if (_stats.estimated_ma <= _budget->budget_ma or dynamic_ma <= 0.f) {
+            return;
+        }
+        // Only the dynamic part can be scaled down
+        const float scale = std::clamp((_budget->budget_ma - idle_ma) / dynamic_ma, 0.f, 1.f);
+        // Round down, so that the budget is never exceeded
+        const std::uint32_t scale_fixed = std::uint32_t(scale * 65536.f);
+        for (std::uint8_t &v : buffer) {
+            v = std::uint8_t((v * scale_fixed) >> 16);
+        }
+        _stats.scale = scale;
+        _stats.limited_ma = idle_ma + dynamic_ma * scale;
     }
 
     std::size_t led_encoder::encode(rmt_channel_handle_t tx_channel, const void *primary_data, std::size_t data_size, rmt_encode_state_t *ret_state) {
@@ -50,26 +447,99 @@ namespace neo {
         : rmt_encoder_t{.encode = nullptr, .reset = nullptr, .del = nullptr},
           _bytes_encoder{nullptr},
           _tail_encoder{nullptr},
+          _direct_encoder{nullptr},
+          _stream_encoder{nullptr},
+          _symbols_encoder{nullptr},
+          _bits_cfg{},
           _reset_sym{},
           _chn_seq{},
-          _rmt_chn{nullptr} {
+          _rmt_chn{nullptr},
+          _buffers(1) {
         static_assert(static_cast<rmt_encoder_t *>(static_cast<led_encoder *>(nullptr)) == static_cast<led_encoder *>(nullptr));
     }
 
-    led_encoder::led_encoder(encoding enc, rmt_tx_channel_config_t config)
+    led_encoder::led_encoder(encoding enc, rmt_tx_channel_config_t config, std::size_t num_buffers)
         : rmt_encoder_t{.encode = &_encode, .reset = &_reset, .del = &_del},
           _bytes_encoder{nullptr},
           _tail_encoder{nullptr},
+          _direct_encoder{nullptr},
+          _stream_encoder{nullptr},
+          _symbols_encoder{nullptr},
+          _bits_cfg{enc.rmt_encoder_cfg},
           _reset_sym{enc.rmt_reset_sym},
           _chn_seq{enc.chn_seq},
-          _rmt_chn{nullptr} {
+          _rmt_chn{nullptr},
+          _buffers(std::max(num_buffers, std::size_t(1))),
+          _sync{std::make_unique<tx_sync>()} {
         ESP_ERROR_CHECK(rmt_new_bytes_encoder(&enc.rmt_encoder_cfg, &_bytes_encoder));
         ESP_ERROR_CHECK(rmt_new_copy_encoder(&rmt_copy_encoder_config, &_tail_encoder));
+        ESP_ERROR_CHECK(rmt_new_copy_encoder(&rmt_copy_encoder_config, &_symbols_encoder));
+#if LIBNEON_DIRECT_TRANSMIT
+        // Whole LEDs are written at each refill
+        const rmt_simple_encoder_config_t direct_encoder_config{.callback = &_encode_direct, .arg = nullptr, .min_chunk_size = 8 * _chn_seq.size()};
+        ESP_ERROR_CHECK(rmt_new_simple_encoder(&direct_encoder_config, &_direct_encoder));
+        const rmt_simple_encoder_config_t stream_encoder_config{.callback = &_encode_stream, .arg = nullptr, .min_chunk_size = 8 * _chn_seq.size()};
+        ESP_ERROR_CHECK(rmt_new_simple_encoder(&stream_encoder_config, &_stream_encoder));
+#endif
         ESP_ERROR_CHECK(rmt_new_tx_channel(&config, &_rmt_chn));
+        // Callbacks must be registered while the channel is disabled
+        const rmt_tx_event_callbacks_t callbacks{.on_trans_done = &_on_trans_done};
+        ESP_ERROR_CHECK(rmt_tx_register_event_callbacks(_rmt_chn, &callbacks, _sync.get()));
         ESP_ERROR_CHECK(rmt_enable(_rmt_chn));
     }
 
+    led_encoder::led_encoder(led_encoder &&other) noexcept : led_encoder{} {
+        *this = std::move(other);
+    }
+
+    led_encoder &led_encoder::operator=(led_encoder &&other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+        release();
+        // Transmissions in progress pass the address of other to the RMT driver
+        other.wait_idle();
+        static_cast<rmt_encoder_t &>(*this) = std::exchange(static_cast<rmt_encoder_t &>(other), rmt_encoder_t{.encode = nullptr, .reset = nullptr, .del = nullptr});
+        _bytes_encoder = std::exchange(other._bytes_encoder, nullptr);
+        _tail_encoder = std::exchange(other._tail_encoder, nullptr);
+        _direct_encoder = std::exchange(other._direct_encoder, nullptr);
+        _stream_encoder = std::exchange(other._stream_encoder, nullptr);
+        _symbols_encoder = std::exchange(other._symbols_encoder, nullptr);
+        _bits_cfg = std::exchange(other._bits_cfg, {});
+        _reset_sym = std::exchange(other._reset_sym, {});
+        _chn_seq = std::exchange(other._chn_seq, {});
+        _rmt_chn = std::exchange(other._rmt_chn, nullptr);
+        // Moving the vector keeps the buffers where they are. The moved-from encoder needs at least one buffer
+        _buffers = std::exchange(other._buffers, std::vector<tx_buffer>(1));
+        _last_buffer = std::exchange(other._last_buffer, 0);
+        _submitted_frames = std::exchange(other._submitted_frames, 0);
+        // Registered with the channel, and on the heap, so it does not move
+        _sync = std::move(other._sync);
+        _budget = std::exchange(other._budget, std::nullopt);
+        _stats = std::exchange(other._stats, {});
+        _cache = std::exchange(other._cache, {});
+        _cache_cap = std::exchange(other._cache_cap, 0);
+        _cache_hits = std::exchange(other._cache_hits, 0);
+        _cache_misses = std::exchange(other._cache_misses, 0);
+        _last_miss_hash = std::exchange(other._last_miss_hash, std::nullopt);
+        _tracked_source = std::exchange(other._tracked_source, nullptr);
+        return *this;
+    }
+
+    void led_encoder::wait_idle() {
+        if (_rmt_chn != nullptr) {
+            // The buffers and this encoder must outlive the transmissions in progress
+            ESP_ERROR_CHECK(wait_all_done());
+            ESP_ERROR_CHECK(rmt_tx_wait_all_done(_rmt_chn, -1));
+        }
+    }
+
     led_encoder::~led_encoder() {
+        release();
+    }
+
+    void led_encoder::release() {
+        wait_idle();
         if (_bytes_encoder != nullptr) {
             ESP_ERROR_CHECK(rmt_del_encoder(_bytes_encoder));
             _bytes_encoder = nullptr;
@@ -78,6 +548,18 @@ namespace neo {
             ESP_ERROR_CHECK(rmt_del_encoder(_tail_encoder));
             _tail_encoder = nullptr;
         }
+        if (_direct_encoder != nullptr) {
+            ESP_ERROR_CHECK(rmt_del_encoder(_direct_encoder));
+            _direct_encoder = nullptr;
+        }
+        if (_stream_encoder != nullptr) {
+            ESP_ERROR_CHECK(rmt_del_encoder(_stream_encoder));
+            _stream_encoder = nullptr;
+        }
+        if (_symbols_encoder != nullptr) {
+            ESP_ERROR_CHECK(rmt_del_encoder(_symbols_encoder));
+            _symbols_encoder = nullptr;
+        }
         if (_rmt_chn != nullptr) {
             ESP_ERROR_CHECK(rmt_disable(_rmt_chn));
             ESP_ERROR_CHECK(rmt_del_channel(_rmt_chn));
@@ -0,0 +1,113 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#include <algorithm>
+#include <neo/executor.hpp>
+
+#ifdef ESP_PLATFORM
+#include <esp_pthread.h>
+#include <freertos/FreeRTOS.h>
+#endif
+
+namespace neo {
+
+    std::size_t inline_executor::concurrency() const {
+        return 1;
+    }
+
+    void inline_executor::run(std::size_t num_jobs, std::function<void(std::size_t)> const &job) {
+        for (std::size_t i = 0; i < num_jobs; ++i) {
+            job(i);
+        }
+    }
+
+    std::size_t thread_executor::default_num_workers() {
+#ifdef ESP_PLATFORM
+        return portNUM_PROCESSORS - 1;
+#else
+        // hardware_concurrency may return 0 if it cannot tell
+        return std::max(std::thread::hardware_concurrency(), 1u) - 1;
+#endif
+    }
+
+    thread_executor::thread_executor(std::size_t num_workers, [[maybe_unused]] int first_core) {
+        _workers.reserve(num_workers);
+#ifdef ESP_PLATFORM
+        const esp_pthread_cfg_t default_cfg = esp_pthread_get_default_config();
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            esp_pthread_cfg_t cfg = default_cfg;
+            cfg.thread_name = "neo::worker";
+            if (first_core != no_affinity) {
+                cfg.pin_to_core = int((std::size_t(first_core) + 1 + i) % portNUM_PROCESSORS);
+            }
+            ESP_ERROR_CHECK(esp_pthread_set_cfg(&cfg));
+            _workers.emplace_back([this] { worker_body(); });
+        }
+        // Do not affect threads created afterwards
+        ESP_ERROR_CHECK(esp_pthread_set_cfg(&default_cfg));
+#else
+        // Plain threads, without affinity
+        for (std::size_t i = 0; i < num_workers; ++i) {
+            _workers.emplace_back([this] { worker_body(); });
+        }
+#endif
+    }
+
+    std::size_t thread_executor::concurrency() const {
+        return _workers.size() + 1;
+    }
+
+    void thread_executor::drain(std::unique_lock<std::mutex> &lock) {
+        while (_next_job < _num_jobs) {
+            const std::size_t i = _next_job++;
+            lock.unlock();
+            (*_job)(i);
+            lock.lock();
+            if (--_pending_jobs == 0) {
+                _done_cv.notify_all();
+            }
+        }
+    }
+
+    void thread_executor::run(std::size_t num_jobs, std::function<void(std::size_t)> const &job) {
+        if (num_jobs == 0) {
+            return;
+        }
+        std::unique_lock<std::mutex> lock{_mtx};
+        _job = &job;
+        _num_jobs = num_jobs;
+        _next_job = 0;
+        _pending_jobs = num_jobs;
+        ++_generation;
+        _work_cv.notify_all();
+        drain(lock);
+        _done_cv.wait(lock, [&] { return _pending_jobs == 0; });
+        _job = nullptr;
+    }
+
+    void thread_executor::worker_body() {
+        std::unique_lock<std::mutex> lock{_mtx};
+        std::size_t seen_generation = _generation;
+        while (true) {
+            _work_cv.wait(lock, [&] { return _stop or _generation != seen_generation; });
+            if (_stop) {
+                return;
+            }
+            seen_generation = _generation;
+            drain(lock);
+        }
+    }
+
+    thread_executor::~thread_executor() {
+        {
+            const std::lock_guard<std::mutex> lock{_mtx};
+            _stop = true;
+        }
+        _work_cv.notify_all();
+        for (std::thread &worker : _workers) {
+            worker.join();
+        }
+    }
+
+}// namespace neo
@@ -0,0 +1,73 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#include <neo/extractor.hpp>
+
+namespace neo {
+
+    corrected_channel_extractor::corrected_channel_extractor(float gamma, std::array<float, 3> correction, float brightness)
+        : _gamma_linear{linear_gamma_channel_extractor{gamma}.lut},
+          _correction{correction},
+          _brightness{brightness} {
+        for (std::uint16_t val = 0x00; val <= 0xff; ++val) {
+            const float v = srgb::to_linear(std::uint8_t(val));
+            _gamma_srgb[val] = std::uint16_t(std::round(std::clamp(gamma == 1.f ? v : std::pow(v, gamma), 0.f, 1.f) * float(0xff00)));
+        }
+        rebuild();
+    }
+
+    corrected_channel_extractor::corrected_channel_extractor(corrected_channel_extractor const &other)
+        : _gamma_linear{other._gamma_linear},
+          _gamma_srgb{other._gamma_srgb},
+          _correction{other._correction},
+          _brightness{other._brightness} {
+        _tables[0] = other.front();
+    }
+
+    corrected_channel_extractor &corrected_channel_extractor::operator=(corrected_channel_extractor const &other) {
+        if (this != &other) {
+            _gamma_linear = other._gamma_linear;
+            _gamma_srgb = other._gamma_srgb;
+            _correction = other._correction;
+            _brightness = other._brightness;
+            rebuild();
+        }
+        return *this;
+    }
+
+    float corrected_channel_extractor::brightness() const {
+        return _brightness;
+    }
+
+    std::array<float, 3> const &corrected_channel_extractor::correction() const {
+        return _correction;
+    }
+
+    void corrected_channel_extractor::set_brightness(float brightness) {
+        _brightness = brightness;
+        rebuild();
+    }
+
+    void corrected_channel_extractor::set_correction(std::array<float, 3> correction) {
+        _correction = correction;
+        rebuild();
+    }
+
+    void corrected_channel_extractor::rebuild() {
+        const std::uint8_t back = 1 - _front.load(std::memory_order_relaxed);
+        tables &t = _tables[back];
+        for (std::size_t c = 0; c < 3; ++c) {
+            // Scale in 16.16 fixed point; all products fit in 32 bits because the knots are at most 0xff00
+            const std::uint32_t scale = unit_to_fixed(_correction[c] * _brightness);
+            for (std::size_t i = 0; i < t.linear[c].size(); ++i) {
+                t.linear[c][i] = std::uint16_t((_gamma_linear[i] * scale + 0x8000) >> 16);
+            }
+            for (std::size_t i = 0; i < t.srgb[c].size(); ++i) {
+                t.srgb[c][i] = std::uint8_t((_gamma_srgb[i] * scale + 0x800000) >> 24);
+            }
+        }
+        _front.store(back, std::memory_order_release);
+    }
+
+}// namespace neo
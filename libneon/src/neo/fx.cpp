@@ -2,44 +2,457 @@
 // Created by spak on 8/19/23.
 //
 
+#include <esp_log.h>
 #include <neo/encoder.hpp>
 #include <neo/fx.hpp>
 
 namespace neo {
     using namespace literals;
 
+    namespace {
+        /**
+         * Source of the stamps of @ref fx_base::invalidate, shared by all effects.
+         */
+        std::atomic<std::uint32_t> _last_invalidation = 0;
+
+        /**
+         * Same as @ref fx_base::uniform_color, but a missing effect renders black.
+         */
+        [[nodiscard]] std::optional<linear_rgb16> uniform_color_or_black(std::shared_ptr<fx_base> const &fx, alarm const &a) {
+            return fx ? fx->uniform_color(a) : linear_rgb16{};
+        }
+
+        /**
+         * Renders `lo` blended with `hi` by `t` into `colors`, where `lo_col` and `hi_col` are their uniform colors, if
+         * any, and `render(fx, range)` renders a non-uniform effect. Uniform inputs are blended as constants, in place; a
+         * scratch buffer is borrowed only if neither is uniform.
+         */
+        template <class Render>
+        void blend_rendered(fx_base *lo, std::optional<linear_rgb16> lo_col, fx_base *hi, std::optional<linear_rgb16> hi_col, float t,
+                            linear_color_range colors, Render const &render) {
+            // Missing effects are uniform, so below lo and hi are never null when they are rendered
+            if (lo_col and hi_col) {
+                std::fill(std::begin(colors), std::end(colors), lo_col->blend(*hi_col, t));
+            } else if (lo_col) {
+                render(*hi, colors);
+                blend_batch(*lo_col, colors, colors, t);
+            } else if (hi_col) {
+                render(*lo, colors);
+                blend_batch(colors, *hi_col, colors, t);
+            } else {
+                const auto scratch = frame_arena::current().borrow<linear_rgb16>(colors.size());
+                const linear_color_range rg = scratch.range();
+                render(*lo, rg);
+                render(*hi, colors);
+                blend_batch(rg, colors, colors, t);
+            }
+        }
+
+        void populate_blended(alarm const &a, std::shared_ptr<fx_base> const &lo, std::shared_ptr<fx_base> const &hi, float t, linear_color_range colors) {
+            blend_rendered(lo.get(), uniform_color_or_black(lo, a), hi.get(), uniform_color_or_black(hi, a), t, colors,
+                           [&](fx_base &fx, linear_color_range rg) { fx.populate_linear(a, rg); });
+        }
+
+        /**
+         * Tile counterpart of @ref populate_blended, with the state computed by @ref prepare_blended.
+         */
+        void populate_blended_tile(detail::prepared_blend const &prepared, std::shared_ptr<fx_base> const &lo, std::shared_ptr<fx_base> const &hi,
+                                   linear_color_range tile, std::size_t offset, std::size_t num_leds) {
+            blend_rendered(lo.get(), prepared.lo_col, hi.get(), prepared.hi_col, prepared.factor, tile,
+                           [&](fx_base const &fx, linear_color_range rg) { fx.populate_tile(rg, offset, num_leds); });
+        }
+
+        [[nodiscard]] detail::prepared_blend prepare_blended(alarm const &a, std::shared_ptr<fx_base> const &lo, std::shared_ptr<fx_base> const &hi,
+                                                             float t, std::size_t num_leds) {
+            for (fx_base *fx : {lo.get(), hi.get()}) {
+                if (fx != nullptr) {
+                    fx->prepare(a, num_leds);
+                }
+            }
+            return {t, uniform_color_or_black(lo, a), uniform_color_or_black(hi, a)};
+        }
+
+        [[nodiscard]] bool tile_safe_or_null(std::shared_ptr<fx_base> const &fx) {
+            return not fx or fx->tile_safe();
+        }
+
+#if LIBNEON_DIRECT_TRANSMIT
+        /**
+         * State of a callback made by @ref fx_base::make_stream_callback. It is read by the RMT interrupt until the last
+         * frame is done, so it is shared by all copies of the callback and waits for that frame before going away.
+         */
+        struct stream_state {
+            led_encoder &encoder;
+            std::size_t num_leds;
+            std::vector<linear_rgb16> ring;
+            std::unique_ptr<stream_frame> frame;
+            /**
+             * Used for effects that are not @ref fx_base::tile_safe; allocated on first use.
+             */
+            std::vector<linear_rgb16> full_frame = {};
+            frame_arena arena = {};
+            std::uint32_t last_frame = 0;
+            std::size_t reported_underrun_leds = 0;
+
+            stream_state(led_encoder &encoder_, std::size_t num_leds_, std::size_t chunk_leds, std::size_t num_slots)
+                : encoder{encoder_},
+                  num_leds{num_leds_},
+                  ring(chunk_leds * num_slots),
+                  frame{encoder.make_stream_frame(std::span<linear_rgb16 const>{ring}, num_leds, chunk_leds, linear_channel_extractor())} {}
+
+            stream_state(stream_state const &) = delete;
+            stream_state &operator=(stream_state const &) = delete;
+
+            void report_underruns() {
+                const std::size_t underrun_leds = frame->underrun_leds.load(std::memory_order_relaxed);
+                if (underrun_leds != reported_underrun_leds) {
+                    ESP_LOGW("NEO", "%d LEDs were sent black, since they were not rendered in time.", int(underrun_leds - reported_underrun_leds));
+                    reported_underrun_leds = underrun_leds;
+                }
+            }
+
+            void render_chunk(fx_base const &fx, std::size_t chunk) {
+                const std::size_t first = chunk * frame->chunk_leds;
+                const auto slot = std::next(std::begin(ring), std::ptrdiff_t(frame->slot_offset(chunk)));
+                fx.populate_tile({slot, std::next(slot, std::ptrdiff_t(std::min(frame->chunk_leds, num_leds - first)))}, first, num_leds);
+                frame->publish_chunk();
+            }
+
+            void stream(fx_base &fx, alarm const &a) {
+                fx.prepare(a, num_leds);
+                frame->restart();
+                // Fill the ring before starting, then render each chunk as soon as its slot is free
+                const std::size_t num_chunks = frame->num_chunks();
+                const std::size_t lead_chunks = std::min(frame->num_slots, num_chunks);
+                for (std::size_t i = 0; i < lead_chunks; ++i) {
+                    render_chunk(fx, i);
+                }
+                ESP_ERROR_CHECK(encoder.transmit_stream(*frame));
+                last_frame = encoder.last_frame();
+                for (std::size_t i = lead_chunks; i < num_chunks; ++i) {
+                    ESP_ERROR_CHECK(frame->wait_slot(i));
+                    render_chunk(fx, i);
+                }
+            }
+
+            void render_full(fx_base &fx, alarm const &a) {
+                full_frame.resize(num_leds);
+                fx.populate_linear(a, full_frame);
+                ESP_ERROR_CHECK(encoder.transmit_direct(full_frame, linear_channel_extractor()));
+                last_frame = encoder.last_frame();
+            }
+
+            ~stream_state() {
+                ESP_ERROR_CHECK(encoder.wait_done(last_frame));
+            }
+        };
+#endif
+    }// namespace
+
+    fx_base::fx_base(fx_base const &) : std::enable_shared_from_this<fx_base>{} {}
+
+    fx_base &fx_base::operator=(fx_base const &) {
+        return *this;
+    }
+
+    void fx_base::populate_linear(alarm const &a, linear_color_range colors) {
+        const auto scratch = frame_arena::current().borrow<srgb>(colors.size());
+        populate(a, scratch.range());
+        std::transform(std::begin(scratch.range()), std::end(scratch.range()), std::begin(colors),
+                       [](srgb c) { return linear_rgb16{c}; });
+    }
+
+    void fx_base::populate_via_linear(alarm const &a, color_range colors) {
+        const auto scratch = frame_arena::current().borrow<linear_rgb16>(colors.size());
+        populate_linear(a, scratch.range());
+        std::transform(std::begin(scratch.range()), std::end(scratch.range()), std::begin(colors),
+                       [](linear_rgb16 c) { return c.to_srgb(); });
+    }
+
+    std::size_t fx_base::scratch_depth() const {
+        return 1;
+    }
+
+    std::size_t fx_base::scratch_bytes(std::size_t num_leds) const {
+        return scratch_depth() * num_leds * (sizeof(linear_rgb16) + sizeof(srgb));
+    }
+
+    std::optional<linear_rgb16> fx_base::uniform_color(alarm const &) const {
+        return std::nullopt;
+    }
+
+    void fx_base::prepare(alarm const &, std::size_t) {}
+
+    bool fx_base::tile_safe() const {
+        return false;
+    }
+
+    void fx_base::populate_tile(linear_color_range, std::size_t, std::size_t) const {
+        ESP_LOGE("NEO", "populate_tile must be implemented by effects that are tile_safe.");
+        std::abort();
+    }
+
+    void fx_base::populate_tiled(alarm const &a, linear_color_range colors, executor &exec) {
+        if (not tile_safe() or exec.concurrency() <= 1) {
+            populate_linear(a, colors);
+            return;
+        }
+        prepare(a, colors.size());
+        // A few tiles per thread, so that threads that finish early can pick up more work
+        const std::size_t num_leds = colors.size();
+        const std::size_t tile_size = std::max(min_tile_size, (num_leds + 4 * exec.concurrency() - 1) / (4 * exec.concurrency()));
+        const std::size_t num_tiles = (num_leds + tile_size - 1) / tile_size;
+        exec.run(num_tiles, [&](std::size_t i) {
+            const std::size_t first = i * tile_size;
+            const std::size_t last = std::min(first + tile_size, num_leds);
+            populate_tile({std::next(std::begin(colors), std::ptrdiff_t(first)), std::next(std::begin(colors), std::ptrdiff_t(last))}, first, num_leds);
+        });
+    }
+
+    std::chrono::milliseconds fx_base::stable_until(alarm const &a) const {
+        return a.total_elapsed();
+    }
+
+    void fx_base::invalidate() {
+        _invalidated_at = ++_last_invalidation;
+    }
+
+    std::uint32_t fx_base::last_invalidation() const {
+        return _invalidated_at;
+    }
+
+    std::uint32_t fx_base::latest_invalidation(std::uint32_t stamp, std::shared_ptr<fx_base> const &fx) {
+        return fx ? latest_invalidation(stamp, fx->last_invalidation()) : stamp;
+    }
+
+    bool fx_base::can_skip_frame(alarm const &a, std::chrono::milliseconds valid_until, std::uint32_t &seen_invalidation) const {
+        // Read before rendering, so that invalidations that happen while rendering are seen at the next frame
+        const std::uint32_t stamp = last_invalidation();
+        const bool invalidated = stamp != seen_invalidation;
+        seen_invalidation = stamp;
+        return not invalidated and a.total_elapsed() < valid_until;
+    }
+
     void solid_fx::populate(alarm const &, color_range colors) {
         std::fill(std::begin(colors), std::end(colors), color);
     }
 
+    void solid_fx::populate_linear(alarm const &, linear_color_range colors) {
+        std::fill(std::begin(colors), std::end(colors), linear_rgb16{color});
+    }
+
+    std::size_t solid_fx::scratch_depth() const {
+        return 0;
+    }
+
+    std::chrono::milliseconds solid_fx::stable_until(alarm const &) const {
+        return forever;
+    }
+
+    std::optional<linear_rgb16> solid_fx::uniform_color(alarm const &) const {
+        return linear_rgb16{color};
+    }
+
+    bool solid_fx::tile_safe() const {
+        return true;
+    }
+
+    void solid_fx::populate_tile(linear_color_range tile, std::size_t, std::size_t) const {
+        std::fill(std::begin(tile), std::end(tile), linear_rgb16{color});
+    }
+
+    std::size_t gradient_fx::scratch_depth() const {
+        return 0;
+    }
+
+    std::chrono::milliseconds gradient_fx::stable_until(alarm const &a) const {
+        return rotate_cycle_time > 0ms ? a.total_elapsed() : forever;
+    }
+
+    void gradient_fx::bake_if_changed() {
+        if (_baked and mode == _baked_mode and gradient == _baked_gradient) {
+            return;
+        }
+        _texture.bake(gradient, mode);
+        _baked_gradient = gradient;
+        _baked_mode = mode;
+        _baked = true;
+    }
+
     void gradient_fx::populate(alarm const &a, color_range colors) {
         const float rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
-        gradient_sample(std::begin(gradient), std::end(gradient), colors.size(), std::begin(colors), rotation, scale);
+        bake_if_changed();
+        _texture.sample(colors, rotation, scale, interpolate);
     }
 
-    void pulse_fx::populate(const neo::alarm &a, color_range colors) {
-        _buffer.clear();
-        _buffer.resize(colors.size());
-        // Make it black so that we know what the state is
-        std::fill(std::begin(colors), std::end(colors), srgb{});
+    void gradient_fx::populate_linear(alarm const &a, linear_color_range colors) {
+        const float rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
+        bake_if_changed();
+        _texture.sample(colors, rotation, scale, interpolate);
+    }
+
+    void gradient_fx::prepare(alarm const &a, std::size_t) {
+        _rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
+        bake_if_changed();
+    }
+
+    bool gradient_fx::tile_safe() const {
+        return true;
+    }
+
+    void gradient_fx::populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const {
+        _texture.sample_slice(tile, offset, num_leds, _rotation, scale, interpolate);
+    }
+
+    std::size_t gradient_morph_fx::scratch_depth() const {
+        return 0;
+    }
+
+    std::chrono::milliseconds gradient_morph_fx::stable_until(alarm const &a) const {
+        return morph_cycle_time > 0ms or rotate_cycle_time > 0ms ? a.total_elapsed() : forever;
+    }
+
+    void gradient_morph_fx::morph(alarm const &a) {
+        float t = morph_cycle_time > 0ms ? a.cycle_time(morph_cycle_time) : 0.f;
+        // Back and forth, as in pulse_fx
+        t = 1.f - 2.f * std::abs(t - 0.5f);
+        const std::uint32_t weight = unit_to_fixed(t);
+
+        const std::size_t n = std::max(from.size(), to.size());
+        _morphed.resize(n);
+        if (from.empty() or to.empty()) {
+            std::copy(std::begin(from.empty() ? to : from), std::end(from.empty() ? to : from), std::begin(_morphed));
+            return;
+        }
+        // Index of the entry paired with the i-th morphed entry, spreading the repeated entries evenly
+        const auto paired = [&](std::vector<gradient_entry> const &g, std::size_t i) -> gradient_entry const & {
+            return n > 1 ? g[(i * (g.size() - 1) + (n - 1) / 2) / (n - 1)] : g.front();
+        };
+        for (std::size_t i = 0; i < n; ++i) {
+            gradient_entry const &l = paired(from, i);
+            gradient_entry const &r = paired(to, i);
+            _morphed[i] = {std::lerp(l.pos, r.pos, t), l.col.blend_fixed(r.col, weight)};
+        }
+    }
+
+    void gradient_morph_fx::populate(alarm const &a, color_range colors) {
+        const float rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
+        morph(a);
+        gradient_sample(std::begin(_morphed), std::end(_morphed), colors.size(), std::begin(colors), rotation, scale, blend_op::linear_lut{});
+    }
 
-        color_range rg{_buffer};
+    void gradient_morph_fx::populate_linear(alarm const &a, linear_color_range colors) {
+        const float rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
+        morph(a);
+        const auto blend_to_linear = [](srgb l, srgb r, float t) -> linear_rgb16 {
+            return linear_rgb16{l}.blend(linear_rgb16{r}, t);
+        };
+        gradient_sample(std::begin(_morphed), std::end(_morphed), colors.size(), std::begin(colors), rotation, scale, blend_to_linear);
+    }
+
+    std::size_t hue_rotate_fx::scratch_depth() const {
+        return 0;
+    }
+
+    std::chrono::milliseconds hue_rotate_fx::stable_until(alarm const &a) const {
+        return rotate_cycle_time > 0ms ? a.total_elapsed() : forever;
+    }
+
+    void hue_rotate_fx::prepare(alarm const &a, std::size_t num_leds) {
+        const float rotation = rotate_cycle_time > 0ms ? a.cycle_time(rotate_cycle_time) : 0.f;
+        // Hue as a fraction of a turn, so that it wraps around the wheel for free
+        _hue_phase = unit_to_phase(rotation);
+        _hue_step = num_leds > 0 ? unit_to_phase(scale / float(num_leds)) : 0;
+    }
+
+    void hue_rotate_fx::fill_hsv(std::span<hsv16> out, std::size_t offset) const {
+        std::uint32_t hue = _hue_phase + _hue_step * std::uint32_t(offset);
+        const std::uint16_t s = unit_to_u16(saturation);
+        const std::uint16_t v = unit_to_u16(value);
+        for (hsv16 &c : out) {
+            c = {std::uint16_t(hue >> 16), s, v};
+            hue += _hue_step;
+        }
+    }
+
+    void hue_rotate_fx::populate_hsv(alarm const &a, std::size_t num_leds) {
+        prepare(a, num_leds);
+        _buffer.resize(num_leds);
+        fill_hsv(_buffer, 0);
+    }
+
+    bool hue_rotate_fx::tile_safe() const {
+        return true;
+    }
 
-        if (lo) {
-            lo->populate(a, rg);
+    void hue_rotate_fx::populate_tile(linear_color_range tile, std::size_t offset, std::size_t) const {
+        // Convert in small chunks on the stack, _buffer cannot be shared between threads
+        std::array<hsv16, 32> chunk{};
+        for (std::size_t first = 0; first < tile.size(); first += chunk.size()) {
+            const std::span<hsv16> hsv{chunk.data(), std::min(chunk.size(), tile.size() - first)};
+            fill_hsv(hsv, offset + first);
+            convert_batch(hsv, std::span<linear_rgb16>{std::to_address(std::begin(tile)) + first, hsv.size()});
         }
-        if (hi) {
-            hi->populate(a, colors);
+    }
+
+    void hue_rotate_fx::populate(alarm const &a, color_range colors) {
+        populate_hsv(a, colors.size());
+        convert_batch(_buffer, colors);
+    }
+
+    void hue_rotate_fx::populate_linear(alarm const &a, linear_color_range colors) {
+        populate_hsv(a, colors.size());
+        convert_batch(_buffer, colors);
+    }
+
+    void pulse_fx::populate(const neo::alarm &a, color_range colors) {
+        populate_via_linear(a, colors);
+    }
+
+    std::size_t pulse_fx::scratch_depth() const {
+        return 1 + std::max(lo ? lo->scratch_depth() : 0, hi ? hi->scratch_depth() : 0);
+    }
+
+    std::chrono::milliseconds pulse_fx::stable_until(alarm const &a) const {
+        if (cycle_time > 0ms) {
+            return a.total_elapsed();
         }
+        return std::min(lo ? lo->stable_until(a) : forever, hi ? hi->stable_until(a) : forever);
+    }
 
-        float t = cycle_time > 0ms ? a.cycle_time(cycle_time) : 0.f;
+    std::uint32_t pulse_fx::last_invalidation() const {
+        return latest_invalidation(latest_invalidation(fx_base::last_invalidation(), lo), hi);
+    }
 
+    float pulse_fx::blend_factor(alarm const &a) const {
+        const float t = cycle_time > 0ms ? a.cycle_time(cycle_time) : 0.f;
         // Cycle is really half of it
-        t = 1.f - 2.f * std::abs(t - 0.5f);
+        return 1.f - 2.f * std::abs(t - 0.5f);
+    }
 
-        broadcast_blend(std::begin(rg), std::end(rg),
-                        std::begin(colors), std::end(colors),
-                        std::begin(colors), t);
+    std::optional<linear_rgb16> pulse_fx::uniform_color(alarm const &a) const {
+        const std::optional<linear_rgb16> lo_col = uniform_color_or_black(lo, a);
+        const std::optional<linear_rgb16> hi_col = uniform_color_or_black(hi, a);
+        if (lo_col and hi_col) {
+            return lo_col->blend(*hi_col, blend_factor(a));
+        }
+        return std::nullopt;
+    }
+
+    void pulse_fx::populate_linear(const neo::alarm &a, linear_color_range colors) {
+        populate_blended(a, lo, hi, blend_factor(a), colors);
+    }
+
+    void pulse_fx::prepare(alarm const &a, std::size_t num_leds) {
+        _prepared = prepare_blended(a, lo, hi, blend_factor(a), num_leds);
+    }
+
+    bool pulse_fx::tile_safe() const {
+        return tile_safe_or_null(lo) and tile_safe_or_null(hi);
+    }
+
+    void pulse_fx::populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const {
+        populate_blended_tile(_prepared, lo, hi, tile, offset, num_leds);
     }
 
     bool transition_fx::transition::is_complete(std::chrono::milliseconds t) const {
@@ -47,70 +460,517 @@ namespace neo {
     }
 
     float transition_fx::transition::compute_blend_factor(std::chrono::milliseconds t) const {
+        if (transition_duration <= 0ms) {
+            return 1.f;
+        }
         return std::clamp(float(t.count() - activation_time.count()) / float(transition_duration.count()), 0.f, 1.f);
     }
 
-    void transition_fx::pop_expired(std::chrono::milliseconds t) {
-        while (_active_transitions.size() > 1 and _active_transitions[1].is_complete(t)) {
-            // If the next transition is complete, the predecessor is not needed
-            _active_transitions.pop_front();
+    void transition_fx::start_requested(alarm const &a, std::size_t num_leds) {
+        std::optional<transition> latest = std::nullopt;
+        while (auto request = _requests.pop()) {
+            latest = std::move(request);
+        }
+        if (not latest) {
+            return;
         }
+        if (_target.fx and not _target.is_complete(a.total_elapsed())) {
+            // Freeze the blend in progress, so that we never render more than two effects
+            _snapshot.resize(num_leds);
+            populate_current(a, _snapshot);
+            _source = nullptr;
+            _snapshot_active = true;
+        } else if (_target.fx and freeze_outgoing) {
+            _snapshot.resize(num_leds);
+            _target.fx->populate_linear(a, _snapshot);
+            _source = nullptr;
+            _snapshot_active = true;
+        } else {
+            // Keep animating the outgoing effect (or fade from black if there is none)
+            _source = std::move(_target.fx);
+            _snapshot_active = false;
+        }
+        _target = std::move(*latest);
+    }
+
+    void transition_fx::populate_current(alarm const &a, linear_color_range colors) {
+        if (not _target.fx) {
+            std::fill(std::begin(colors), std::end(colors), linear_rgb16{});
+            return;
+        }
+        if (_target.is_complete(a.total_elapsed())) {
+            _target.fx->populate_linear(a, colors);
+            return;
+        }
+        const float blend_factor = _target.compute_blend_factor(a.total_elapsed());
+        if (not _snapshot_active) {
+            populate_blended(a, _source, _target.fx, blend_factor, colors);
+            return;
+        }
+        // Fade out the snapshot, which may be the output buffer itself
+        const std::size_t n = std::min(colors.size(), _snapshot.size());
+        if (n > 0 and std::to_address(std::begin(colors)) != _snapshot.data()) {
+            std::copy_n(std::begin(_snapshot), n, std::begin(colors));
+        }
+        std::fill(std::next(std::begin(colors), std::ptrdiff_t(n)), std::end(colors), linear_rgb16{});
+        const auto scratch = frame_arena::current().borrow<linear_rgb16>(colors.size());
+        const linear_color_range rg = scratch.range();
+        _target.fx->populate_linear(a, rg);
+        blend_batch(colors, rg, colors, blend_factor);
     }
 
     void transition_fx::populate(const neo::alarm &a, color_range colors) {
-        std::fill(std::begin(colors), std::end(colors), 0x0_rgb);
+        populate_via_linear(a, colors);
+    }
 
-        pop_expired(a.total_elapsed());
-        _buffer.clear();
-        _buffer.resize(colors.size());
+    std::size_t transition_fx::scratch_depth() const {
+        std::size_t depth = std::max(_source ? _source->scratch_depth() : 0, _target.fx ? _target.fx->scratch_depth() : 0);
+        // Pending requests start at the next frame, which then renders one of them together with the current effects
+        _requests.for_each([&](transition const &request) {
+            depth = std::max(depth, request.fx ? request.fx->scratch_depth() : 0);
+        });
+        return 1 + depth;
+    }
 
-        color_range rg{_buffer};
+    std::chrono::milliseconds transition_fx::stable_until(alarm const &a) const {
+        if (not _requests.empty() or (_target.fx and not _target.is_complete(a.total_elapsed()))) {
+            // About to start or blending, changes at every frame
+            return a.total_elapsed();
+        }
+        return _target.fx ? _target.fx->stable_until(a) : forever;
+    }
 
-        for (transition const &item : _active_transitions) {
-            if (item.is_complete(a.total_elapsed())) {
-                // Just take the final result
-                item.fx->populate(a, colors);
-                continue;
-            }
-            // Blend the old colors with the new
-            const float blend_factor = item.compute_blend_factor(a.total_elapsed());
-            item.fx->populate(a, rg);
-            broadcast_blend(std::begin(colors), std::end(colors),
-                            std::begin(rg), std::end(rg),
-                            std::begin(colors), blend_factor);
+    std::optional<linear_rgb16> transition_fx::uniform_color(alarm const &a) const {
+        if (not _requests.empty()) {
+            return std::nullopt;
         }
+        if (not _target.fx) {
+            return linear_rgb16{};
+        }
+        return _target.is_complete(a.total_elapsed()) ? _target.fx->uniform_color(a) : std::nullopt;
+    }
+
+    std::uint32_t transition_fx::last_invalidation() const {
+        return latest_invalidation(latest_invalidation(fx_base::last_invalidation(), _source), _target.fx);
     }
 
-    void transition_fx::transition_to(alarm const &a, std::shared_ptr<fx_base> fx, std::chrono::milliseconds duration) {
-        _active_transitions.emplace_back(transition{a.total_elapsed(), duration, std::move(fx)});
+    void transition_fx::populate_linear(const neo::alarm &a, linear_color_range colors) {
+        start_requested(a, colors.size());
+        if (_target.fx and _target.is_complete(a.total_elapsed())) {
+            // The outgoing effect is not needed anymore
+            _source = nullptr;
+            _snapshot_active = false;
+        }
+        populate_current(a, colors);
+    }
+
+    bool transition_fx::transition_to(alarm const &a, std::shared_ptr<fx_base> fx, std::chrono::milliseconds duration) {
+        if (not _requests.push(transition{a.total_elapsed(), duration, std::move(fx)})) {
+            return false;
+        }
+        invalidate();
+        return true;
+    }
+
+
+    std::function<void(alarm &)> fx_base::make_callback(led_encoder &encoder, std::size_t num_leds, bool skip_stable_frames) {
+        frame_arena arena{};
+        arena.reserve(scratch_depth(), num_leds);
+        return [fx = shared_from_this(), buffer = std::vector<neo::linear_rgb16>{num_leds}, arena = std::move(arena), enc = &encoder, num_leds,
+                skip_stable_frames, valid_until = 0ms, seen_invalidation = std::uint32_t(0)](neo::alarm &a) mutable {
+            if (skip_stable_frames and fx->can_skip_frame(a, valid_until, seen_invalidation)) {
+                return;
+            }
+            // Render while the previous frame is on the wire, but only once there is a buffer to extract it into
+            ESP_ERROR_CHECK(enc->wait_free_buffer());
+            // Children may have changed since the last frame, grow the arena now rather than while rendering
+            arena.reserve(fx->scratch_depth(), num_leds);
+            const frame_arena::scope scope{arena};
+            fx->populate_linear(a, buffer);
+            valid_until = fx->stable_until(a);
+            ESP_ERROR_CHECK(enc->transmit(std::begin(buffer), std::end(buffer), neo::linear_channel_extractor()));
+        };
     }
 
+    std::function<void(alarm &)> fx_base::make_tiled_callback(led_encoder &encoder, std::size_t num_leds, executor &exec, bool skip_stable_frames) {
+        // Arena for the tiles rendered by this thread; worker threads use their own fallback arena
+        frame_arena arena{};
+        arena.reserve(scratch_depth(), num_leds);
+        return [fx = shared_from_this(), buffer = std::vector<neo::linear_rgb16>{num_leds}, arena = std::move(arena), enc = &encoder, exec = &exec,
+                num_leds, skip_stable_frames, valid_until = 0ms, seen_invalidation = std::uint32_t(0)](neo::alarm &a) mutable {
+            if (skip_stable_frames and fx->can_skip_frame(a, valid_until, seen_invalidation)) {
+                return;
+            }
+            ESP_ERROR_CHECK(enc->wait_free_buffer());
+            arena.reserve(fx->scratch_depth(), num_leds);
+            const frame_arena::scope scope{arena};
+            fx->populate_tiled(a, buffer, *exec);
+            valid_until = fx->stable_until(a);
+            ESP_ERROR_CHECK(enc->transmit(std::begin(buffer), std::end(buffer), neo::linear_channel_extractor()));
+        };
+    }
 
-    std::function<void(alarm &)> fx_base::make_callback(led_encoder &encoder, std::size_t num_leds) {
-        return [fx = shared_from_this(), buffer = std::vector<neo::srgb>{num_leds}, enc = &encoder](neo::alarm &a) mutable {
-            fx->populate(a, buffer);
-            ESP_ERROR_CHECK(enc->transmit(std::begin(buffer), std::end(buffer), neo::srgb_linear_channel_extractor()));
+#if LIBNEON_DIRECT_TRANSMIT
+    std::function<void(alarm &)> fx_base::make_stream_callback(led_encoder &encoder, std::size_t num_leds, std::size_t chunk_leds, std::size_t num_slots,
+                                                               bool skip_stable_frames) {
+        auto state = std::make_shared<stream_state>(encoder, num_leds, chunk_leds, std::max(num_slots, std::size_t(2)));
+        state->arena.reserve(scratch_depth(), tile_safe() ? chunk_leds : num_leds);
+        return [fx = shared_from_this(), state = std::move(state), skip_stable_frames, valid_until = 0ms,
+                seen_invalidation = std::uint32_t(0)](neo::alarm &a) mutable {
+            if (skip_stable_frames and fx->can_skip_frame(a, valid_until, seen_invalidation)) {
+                return;
+            }
+            // The ring and the full frame are read until the previous frame is done
+            ESP_ERROR_CHECK(state->encoder.wait_done(state->last_frame));
+            state->report_underruns();
+            const bool tile_safe = fx->tile_safe();
+            state->arena.reserve(fx->scratch_depth(), tile_safe ? state->frame->chunk_leds : state->num_leds);
+            const frame_arena::scope scope{state->arena};
+            if (tile_safe) {
+                state->stream(*fx, a);
+            } else {
+                state->render_full(*fx, a);
+            }
+            valid_until = fx->stable_until(a);
         };
     }
+#endif
 
     void blend_fx::populate(const neo::alarm &a, color_range colors) {
-        _buffer.clear();
-        _buffer.resize(colors.size());
-        // Make it black so that we know what the state is
-        std::fill(std::begin(colors), std::end(colors), srgb{});
+        populate_via_linear(a, colors);
+    }
+
+    std::size_t blend_fx::scratch_depth() const {
+        return 1 + std::max(lo ? lo->scratch_depth() : 0, hi ? hi->scratch_depth() : 0);
+    }
+
+    std::chrono::milliseconds blend_fx::stable_until(alarm const &a) const {
+        return std::min(lo ? lo->stable_until(a) : forever, hi ? hi->stable_until(a) : forever);
+    }
+
+    std::uint32_t blend_fx::last_invalidation() const {
+        return latest_invalidation(latest_invalidation(fx_base::last_invalidation(), lo), hi);
+    }
+
+    std::optional<linear_rgb16> blend_fx::uniform_color(alarm const &a) const {
+        const std::optional<linear_rgb16> lo_col = uniform_color_or_black(lo, a);
+        const std::optional<linear_rgb16> hi_col = uniform_color_or_black(hi, a);
+        if (lo_col and hi_col) {
+            return lo_col->blend(*hi_col, blend_factor);
+        }
+        return std::nullopt;
+    }
+
+    void blend_fx::populate_linear(const neo::alarm &a, linear_color_range colors) {
+        populate_blended(a, lo, hi, blend_factor, colors);
+    }
 
-        color_range rg{_buffer};
+    void blend_fx::prepare(alarm const &a, std::size_t num_leds) {
+        _prepared = prepare_blended(a, lo, hi, blend_factor, num_leds);
+    }
+
+    bool blend_fx::tile_safe() const {
+        return tile_safe_or_null(lo) and tile_safe_or_null(hi);
+    }
+
+    void blend_fx::populate_tile(linear_color_range tile, std::size_t offset, std::size_t num_leds) const {
+        populate_blended_tile(_prepared, lo, hi, tile, offset, num_leds);
+    }
+
+    linear_rgb16 layer_fx::plane::operator[](std::size_t i) const {
+        return data != nullptr ? data[i] : constant;
+    }
+
+    bool layer_fx::source::is_opaque() const {
+        return mode == blend_mode::normal and not masked and weight == 0x10000;
+    }
 
-        if (lo) {
-            lo->populate(a, rg);
+    layer_fx::source layer_fx::make_source(layer const &l, alarm const &a) {
+        source s{};
+        s.mode = l.mode;
+        if (not l.mask) {
+            s.weight = unit_to_fixed(l.opacity);
+        } else if (const std::optional<linear_rgb16> mask_col = l.mask->uniform_color(a); mask_col) {
+            s.weight = u16_to_fixed(mul_unit16(unit_to_u16(l.opacity), mask_col->luminance()));
+        } else {
+            s.masked = true;
+            s.weight = unit_to_u16(l.opacity);
         }
-        if (hi) {
-            hi->populate(a, colors);
+        return s;
+    }
+
+    void layer_fx::populate(const neo::alarm &a, color_range colors) {
+        populate_via_linear(a, colors);
+    }
+
+    std::size_t layer_fx::scratch_depth() const {
+        // Same order as render_pending: the i-th plane is rendered while holding i buffers (its own included)
+        std::size_t i = 0;
+        std::size_t depth = 0;
+        for (layer const &l : layers) {
+            for (fx_base const *fx : {l.fx.get(), l.mask.get()}) {
+                if (fx != nullptr) {
+                    depth = std::max(depth, i + fx->scratch_depth());
+                    ++i;
+                }
+            }
         }
+        return depth;
+    }
 
-        broadcast_blend(std::begin(rg), std::end(rg),
-                        std::begin(colors), std::end(colors),
-                        std::begin(colors), blend_factor);
+    std::chrono::milliseconds layer_fx::stable_until(alarm const &a) const {
+        std::chrono::milliseconds t = forever;
+        for (layer const &l : layers) {
+            for (fx_base const *fx : {l.fx.get(), l.mask.get()}) {
+                if (fx != nullptr) {
+                    t = std::min(t, fx->stable_until(a));
+                }
+            }
+        }
+        return t;
+    }
+
+    std::uint32_t layer_fx::last_invalidation() const {
+        std::uint32_t stamp = fx_base::last_invalidation();
+        for (layer const &l : layers) {
+            stamp = latest_invalidation(latest_invalidation(stamp, l.fx), l.mask);
+        }
+        return stamp;
+    }
+
+    std::optional<linear_rgb16> layer_fx::uniform_color(alarm const &a) const {
+        linear_rgb16 acc{};
+        bool varying = false;
+        for (layer const &l : layers) {
+            const source s = make_source(l, a);
+            if (s.weight == 0) {
+                continue;
+            }
+            if (s.is_opaque()) {
+                acc = {};
+                varying = false;
+            }
+            const std::optional<linear_rgb16> col = uniform_color_or_black(l.fx, a);
+            if (s.masked or not col) {
+                varying = true;
+            } else {
+                acc = composite(acc, *col, s.mode, s.weight);
+            }
+        }
+        if (varying) {
+            return std::nullopt;
+        }
+        return acc;
+    }
+
+    void layer_fx::collect_sources(alarm const &a) {
+        _sources.clear();
+        _pending.clear();
+        // _pending points into _sources, which thus must not reallocate
+        _sources.reserve(layers.size());
+        for (layer const &l : layers) {
+            const source s = make_source(l, a);
+            if (s.weight == 0) {
+                continue;
+            }
+            if (s.is_opaque()) {
+                _sources.clear();
+                _pending.clear();
+            }
+            source &added = _sources.emplace_back(s);
+            if (const std::optional<linear_rgb16> col = uniform_color_or_black(l.fx, a); col) {
+                added.color.constant = *col;
+            } else {
+                _pending.push_back({l.fx.get(), &added.color});
+            }
+            if (added.masked) {
+                _pending.push_back({l.mask.get(), &added.mask});
+            }
+        }
+    }
+
+    void layer_fx::render_pending(alarm const &a, linear_color_range colors, std::size_t i) {
+        if (i == _pending.size()) {
+            composite_sources(colors);
+            return;
+        }
+        pending_plane const &p = _pending[i];
+        if (i == 0) {
+            // Safe, because composite_sources reads each pixel before overwriting it
+            p.fx->populate_linear(a, colors);
+            p.target->data = &*std::begin(colors);
+            render_pending(a, colors, i + 1);
+        } else {
+            const auto scratch = frame_arena::current().borrow<linear_rgb16>(colors.size());
+            p.fx->populate_linear(a, scratch.range());
+            p.target->data = &*std::begin(scratch.range());
+            render_pending(a, colors, i + 1);
+        }
+    }
+
+    namespace {
+        /**
+         * Pixels composited at once by @ref layer_fx: layers are applied one after the other to an accumulator this
+         * small, so that the mode is dispatched once per tile and the accumulator never leaves the cache.
+         */
+        constexpr std::size_t layer_tile_size = 32;
+
+        /**
+         * Composites `src` with `Mode` over `acc`. If `mask` is not null, `weight` is in the range 0...0xffff and is
+         * multiplied by the luminance of the mask. Each combination of parameters gets its own branchless loop.
+         */
+        template <blend_mode Mode, bool ConstantSrc, bool Masked>
+        void composite_tile(std::span<linear_rgb16> acc, linear_rgb16 const *src, linear_rgb16 const *mask, std::uint32_t weight) {
+            for (std::size_t i = 0; i < acc.size(); ++i) {
+                const linear_rgb16 col = ConstantSrc ? *src : src[i];
+                const std::uint32_t w = Masked ? u16_to_fixed(mul_unit16(std::uint16_t(weight), mask[i].luminance())) : weight;
+                acc[i] = composite(acc[i], col, Mode, w);
+            }
+        }
+
+        template <blend_mode Mode>
+        void composite_tile(std::span<linear_rgb16> acc, linear_rgb16 const *src, bool constant_src, linear_rgb16 const *mask, std::uint32_t weight) {
+            if (mask != nullptr) {
+                constant_src ? composite_tile<Mode, true, true>(acc, src, mask, weight)
+                             : composite_tile<Mode, false, true>(acc, src, mask, weight);
+            } else {
+                constant_src ? composite_tile<Mode, true, false>(acc, src, mask, weight)
+                             : composite_tile<Mode, false, false>(acc, src, mask, weight);
+            }
+        }
+    }// namespace
+
+    void layer_fx::composite_sources(linear_color_range colors) const {
+        std::array<linear_rgb16, layer_tile_size> acc{};
+        for (std::size_t first = 0; first < colors.size(); first += layer_tile_size) {
+            const std::span<linear_rgb16> tile{acc.data(), std::min(layer_tile_size, colors.size() - first)};
+            // Only the bottom source can be opaque, in which case it is copied rather than composited over black
+            auto it = std::begin(_sources);
+            if (it != std::end(_sources) and it->is_opaque()) {
+                for (std::size_t i = 0; i < tile.size(); ++i) {
+                    tile[i] = it->color[first + i];
+                }
+                ++it;
+            } else {
+                std::fill(std::begin(tile), std::end(tile), linear_rgb16{});
+            }
+            for (; it != std::end(_sources); ++it) {
+                source const &s = *it;
+                const bool constant_src = s.color.data == nullptr;
+                linear_rgb16 const *src = constant_src ? &s.color.constant : s.color.data + first;
+                linear_rgb16 const *mask = s.masked ? s.mask.data + first : nullptr;
+                switch (s.mode) {
+                    case blend_mode::normal:
+                        composite_tile<blend_mode::normal>(tile, src, constant_src, mask, s.weight);
+                        break;
+                    case blend_mode::add:
+                        composite_tile<blend_mode::add>(tile, src, constant_src, mask, s.weight);
+                        break;
+                    case blend_mode::multiply:
+                        composite_tile<blend_mode::multiply>(tile, src, constant_src, mask, s.weight);
+                        break;
+                    case blend_mode::screen:
+                        composite_tile<blend_mode::screen>(tile, src, constant_src, mask, s.weight);
+                        break;
+                    case blend_mode::max:
+                        composite_tile<blend_mode::max>(tile, src, constant_src, mask, s.weight);
+                        break;
+                }
+            }
+            std::copy(std::begin(tile), std::end(tile), std::next(std::begin(colors), std::ptrdiff_t(first)));
+        }
+    }
+
+    void layer_fx::populate_linear(const neo::alarm &a, linear_color_range colors) {
+        if (std::empty(colors)) {
+            return;
+        }
+        collect_sources(a);
+        render_pending(a, colors, 0);
+    }
+
+    template <class Color>
+    void zones_fx::populate_zones(alarm const &a, std::ranges::subrange<typename std::vector<Color>::iterator> colors) {
+        using range_t = std::ranges::subrange<typename std::vector<Color>::iterator>;
+        const auto at = [&](std::size_t i) { return std::next(std::begin(colors), std::ptrdiff_t(i)); };
+
+        // Blacken the gaps first, in case zones do not cover the whole strip
+        _sorted_spans.clear();
+        for (zone const &z : zones) {
+            _sorted_spans.push_back(z.span);
+        }
+        std::sort(std::begin(_sorted_spans), std::end(_sorted_spans), [](index_span const &l, index_span const &r) { return l.first < r.first; });
+        std::size_t covered_until = 0;
+        for (index_span const &s : _sorted_spans) {
+            if (s.first > covered_until) {
+                std::fill(at(std::min(covered_until, colors.size())), at(std::min(s.first, colors.size())), Color{});
+            }
+            covered_until = std::max(covered_until, s.last);
+        }
+        if (covered_until < colors.size()) {
+            std::fill(at(covered_until), std::end(colors), Color{});
+        }
+
+        for (zone const &z : zones) {
+            const std::size_t last = std::min(z.span.last, colors.size());
+            if (z.span.first >= last) {
+                continue;
+            }
+            const std::size_t n = last - z.span.first;
+            const std::size_t n_rendered = z.mirrored ? (n + 1) / 2 : n;
+            const range_t rendered{at(z.span.first), at(z.span.first + n_rendered)};
+            if (not z.fx) {
+                std::fill(std::begin(rendered), std::end(rendered), Color{});
+            } else if constexpr (std::is_same_v<Color, linear_rgb16>) {
+                z.fx->populate_linear(a, rendered);
+            } else {
+                z.fx->populate(a, rendered);
+            }
+            if (z.reversed) {
+                std::reverse(std::begin(rendered), std::end(rendered));
+            }
+            if (z.mirrored) {
+                // The middle pixel of an odd span is not repeated
+                std::reverse_copy(std::begin(rendered), at(z.span.first + n - n_rendered), std::end(rendered));
+            }
+        }
+    }
+
+    void zones_fx::populate(const neo::alarm &a, color_range colors) {
+        populate_zones<srgb>(a, colors);
+    }
+
+    void zones_fx::populate_linear(const neo::alarm &a, linear_color_range colors) {
+        populate_zones<linear_rgb16>(a, colors);
+    }
+
+    std::size_t zones_fx::scratch_depth() const {
+        // Zones render in place, one after the other
+        std::size_t depth = 0;
+        for (zone const &z : zones) {
+            if (z.fx) {
+                depth = std::max(depth, z.fx->scratch_depth());
+            }
+        }
+        return depth;
+    }
+
+    std::chrono::milliseconds zones_fx::stable_until(alarm const &a) const {
+        std::chrono::milliseconds t = forever;
+        for (zone const &z : zones) {
+            if (z.fx) {
+                t = std::min(t, z.fx->stable_until(a));
+            }
+        }
+        return t;
+    }
+
+    std::uint32_t zones_fx::last_invalidation() const {
+        std::uint32_t stamp = fx_base::last_invalidation();
+        for (zone const &z : zones) {
+            stamp = latest_invalidation(stamp, z.fx);
+        }
+        return stamp;
     }
 
-}// namespace neo
\ No newline at end of file
+}// namespace neo
@@ -0,0 +1,61 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#include <neo/gradient.hpp>
+
+namespace neo {
+
+    void gradient_texture::bake(std::span<const gradient_entry> gradient, gradient_mode mode) {
+        if (gradient.empty()) {
+            _texels.fill(linear_rgb16{});
+            return;
+        }
+        if (mode == gradient_mode::oklab) {
+            const auto blend_to_linear = [op = blend_op::oklab{}](srgb l, srgb r, float t) -> linear_rgb16 {
+                return op.blend_to_linear(l, r, t);
+            };
+            gradient_sample(std::begin(gradient), std::end(gradient), resolution, std::begin(_texels), 0.f, 1.f, blend_to_linear);
+        } else {
+            const auto blend_to_linear = [](srgb l, srgb r, float t) -> linear_rgb16 {
+                return linear_rgb16{l}.blend(linear_rgb16{r}, t);
+            };
+            gradient_sample(std::begin(gradient), std::end(gradient), resolution, std::begin(_texels), 0.f, 1.f, blend_to_linear);
+        }
+        // Position 1 is past (or at) the last entry
+        _texels.back() = linear_rgb16{std::max_element(std::begin(gradient), std::end(gradient), safe_less{})->col};
+    }
+
+    template <class Color>
+    void gradient_texture::sample_impl(std::span<Color> out, std::size_t offset, std::size_t num_samples, float rotate, float scale, bool interpolate) const {
+        if (out.empty()) {
+            return;
+        }
+        // Same positions as gradient_sample, i.e. scale * (rotate + i / n), modulo 1
+        const std::uint32_t step = unit_to_phase(scale / float(num_samples));
+        // Wraps around exactly like adding step offset times
+        std::uint32_t phase = unit_to_phase(scale * rotate) + step * std::uint32_t(offset);
+        for (Color &c : out) {
+            if constexpr (std::is_same_v<Color, srgb>) {
+                c = texel_at(phase, interpolate).to_srgb();
+            } else {
+                c = texel_at(phase, interpolate);
+            }
+            phase += step;
+        }
+    }
+
+    void gradient_texture::sample(std::span<linear_rgb16> out, float rotate, float scale, bool interpolate) const {
+        sample_impl(out, 0, out.size(), rotate, scale, interpolate);
+    }
+
+    void gradient_texture::sample(std::span<srgb> out, float rotate, float scale, bool interpolate) const {
+        sample_impl(out, 0, out.size(), rotate, scale, interpolate);
+    }
+
+    void gradient_texture::sample_slice(std::span<linear_rgb16> out, std::size_t offset, std::size_t num_samples, float rotate, float scale,
+                                        bool interpolate) const {
+        sample_impl(out, offset, num_samples, rotate, scale, interpolate);
+    }
+
+}// namespace neo
@@ -0,0 +1,57 @@
+//
+// Created by spak on 10/17/26.
+//
+
+#include <bit>
+#include <neo/oklab.hpp>
+
+namespace neo {
+
+    float fast_cbrt(float x) {
+        if (x <= 0.f) {
+            return 0.f;
+        }
+        // Dividing the exponent by 3 gives a guess within a few percent
+        float y = std::bit_cast<float>(std::bit_cast<std::uint32_t>(x) / 3 + 0x2a514067u);
+        y = (2.f * y + x / (y * y)) * (1.f / 3.f);
+        y = (2.f * y + x / (y * y)) * (1.f / 3.f);
+        return y;
+    }
+
+    oklab oklab::from_linear(std::array<float, 3> const &linear_rgb) {
+        const auto [r, g, b] = linear_rgb;
+        const float l_ = fast_cbrt(0.4122214708f * r + 0.5363325363f * g + 0.0514459929f * b);
+        const float m_ = fast_cbrt(0.2119034982f * r + 0.6806995451f * g + 0.1073969566f * b);
+        const float s_ = fast_cbrt(0.0883024619f * r + 0.2817188376f * g + 0.6299787005f * b);
+        return {0.2104542553f * l_ + 0.7936177850f * m_ - 0.0040720468f * s_,
+                1.9779984951f * l_ - 2.4285922050f * m_ + 0.4505937099f * s_,
+                0.0259040371f * l_ + 0.7827717662f * m_ - 0.8086757660f * s_};
+    }
+
+    oklab::oklab(linear_rgb16 col)
+        : oklab{from_linear({float(col.r) / 65535.f, float(col.g) / 65535.f, float(col.b) / 65535.f})} {}
+
+    oklab::oklab(srgb col) : oklab{linear_rgb16{col}} {}
+
+    std::array<float, 3> oklab::to_linear() const {
+        const float l_ = l + 0.3963377774f * a + 0.2158037573f * b;
+        const float m_ = l - 0.1055613458f * a - 0.0638541728f * b;
+        const float s_ = l - 0.0894841775f * a - 1.2914855480f * b;
+        const float l3 = l_ * l_ * l_;
+        const float m3 = m_ * m_ * m_;
+        const float s3 = s_ * s_ * s_;
+        return {std::clamp(4.0767416621f * l3 - 3.3077115913f * m3 + 0.2309699292f * s3, 0.f, 1.f),
+                std::clamp(-1.2684380046f * l3 + 2.6097574011f * m3 - 0.3413193965f * s3, 0.f, 1.f),
+                std::clamp(-0.0041960863f * l3 - 0.7034186147f * m3 + 1.7076147010f * s3, 0.f, 1.f)};
+    }
+
+    linear_rgb16 oklab::to_linear_rgb16() const {
+        const auto [r, g, b] = to_linear();
+        return {unit_to_u16(r), unit_to_u16(g), unit_to_u16(b)};
+    }
+
+    srgb oklab::to_rgb() const {
+        return to_linear_rgb16().to_srgb();
+    }
+
+}// namespace neo
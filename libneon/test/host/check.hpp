@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdio>
+
+/**
+ * Minimal assertions for the host tests: failures are reported and counted, and the test goes on.
+ */
+namespace check {
+    inline int failures = 0;
+
+    inline void report(bool ok, char const *what, char const *file, int line) {
+        if (not ok) {
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+            ++failures;
+        }
+    }
+
+    /**
+     * @return The exit code of the test.
+     */
+    inline int summary(char const *name) {
+        std::printf("%s: %s\n", name, failures == 0 ? "ok" : "FAILED");
+        return failures == 0 ? 0 : 1;
+    }
+}// namespace check
+
+#define CHECK(cond) check::report(bool(cond), #cond, __FILE__, __LINE__)
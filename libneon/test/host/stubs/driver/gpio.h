@@ -0,0 +1,8 @@
+#pragma once
+
+#include <esp_err.h>
+
+typedef enum {
+    GPIO_NUM_NC = -1,
+    GPIO_NUM_13 = 13,
+} gpio_num_t;
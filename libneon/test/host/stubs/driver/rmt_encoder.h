@@ -0,0 +1,113 @@
+#pragma once
+
+#include "rmt_types.h"
+#include <esp_idf_version.h>
+
+typedef enum {
+    RMT_ENCODING_RESET = 0,
+    RMT_ENCODING_COMPLETE = 1,
+    RMT_ENCODING_MEM_FULL = 2,
+} rmt_encode_state_t;
+
+typedef struct rmt_encoder_t rmt_encoder_t;
+typedef rmt_encoder_t *rmt_encoder_handle_t;
+
+struct rmt_encoder_t {
+    size_t (*encode)(rmt_encoder_t *encoder, rmt_channel_handle_t tx_channel, const void *primary_data, size_t data_size,
+                     rmt_encode_state_t *ret_state);
+    esp_err_t (*reset)(rmt_encoder_t *encoder);
+    esp_err_t (*del)(rmt_encoder_t *encoder);
+};
+
+typedef struct {
+    rmt_symbol_word_t bit0;
+    rmt_symbol_word_t bit1;
+    struct {
+        uint32_t msb_first : 1;
+    } flags;
+} rmt_bytes_encoder_config_t;
+
+typedef struct {
+} rmt_copy_encoder_config_t;
+
+typedef size_t (*rmt_encode_simple_cb_t)(const void *data, size_t data_size, size_t symbols_written, size_t symbols_free,
+                                         rmt_symbol_word_t *symbols, bool *done, void *arg);
+
+typedef struct {
+    rmt_encode_simple_cb_t callback;
+    void *arg;
+    size_t min_chunk_size;
+} rmt_simple_encoder_config_t;
+
+#include <map>
+#include <mutex>
+
+namespace mock_rmt {
+    /**
+     * Encoders created by the driver, which the channel tells apart to decode what goes on the wire. Encoders that
+     * are not in the registry, e.g. composite encoders implemented by the library, are assumed to send bytes as-is.
+     */
+    enum struct encoder_kind {
+        other,
+        bytes,
+        copy,
+        simple
+    };
+
+    struct encoder {
+        rmt_encoder_t base{};
+        encoder_kind kind = encoder_kind::other;
+        rmt_simple_encoder_config_t simple{};
+    };
+
+    inline std::mutex registry_mutex{};
+    inline std::map<rmt_encoder_handle_t, encoder *> registry{};
+
+    inline rmt_encoder_handle_t make_encoder(encoder_kind kind, rmt_simple_encoder_config_t simple = {}) {
+        auto *enc = new encoder{.base = {}, .kind = kind, .simple = simple};
+        const std::lock_guard lock{registry_mutex};
+        registry[&enc->base] = enc;
+        return &enc->base;
+    }
+
+    /**
+     * @return The driver encoder for `handle`, or null if it is not one.
+     */
+    [[nodiscard]] inline encoder const *find_encoder(rmt_encoder_handle_t handle) {
+        const std::lock_guard lock{registry_mutex};
+        auto it = registry.find(handle);
+        return it != registry.end() ? it->second : nullptr;
+    }
+}// namespace mock_rmt
+
+inline esp_err_t rmt_new_bytes_encoder(const rmt_bytes_encoder_config_t *, rmt_encoder_handle_t *ret_encoder) {
+    *ret_encoder = mock_rmt::make_encoder(mock_rmt::encoder_kind::bytes);
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_new_copy_encoder(const rmt_copy_encoder_config_t *, rmt_encoder_handle_t *ret_encoder) {
+    *ret_encoder = mock_rmt::make_encoder(mock_rmt::encoder_kind::copy);
+    return ESP_OK;
+}
+
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 3, 0)
+inline esp_err_t rmt_new_simple_encoder(const rmt_simple_encoder_config_t *config, rmt_encoder_handle_t *ret_encoder) {
+    *ret_encoder = mock_rmt::make_encoder(mock_rmt::encoder_kind::simple, *config);
+    return ESP_OK;
+}
+#endif
+
+inline esp_err_t rmt_del_encoder(rmt_encoder_handle_t handle) {
+    const std::lock_guard lock{mock_rmt::registry_mutex};
+    auto it = mock_rmt::registry.find(handle);
+    if (it == mock_rmt::registry.end()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    delete it->second;
+    mock_rmt::registry.erase(it);
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_encoder_reset(rmt_encoder_handle_t) {
+    return ESP_OK;
+}
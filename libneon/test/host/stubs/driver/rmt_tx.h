@@ -0,0 +1,240 @@
+#pragma once
+
+#include "rmt_encoder.h"
+#include "rmt_types.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef struct {
+    int gpio_num;
+    rmt_clock_source_t clk_src;
+    uint32_t resolution_hz;
+    size_t mem_block_symbols;
+    size_t trans_queue_depth;
+    struct {
+        uint32_t invert_out : 1;
+        uint32_t with_dma : 1;
+        uint32_t io_loop_back : 1;
+        uint32_t io_od_mode : 1;
+    } flags;
+} rmt_tx_channel_config_t;
+
+typedef struct {
+    int loop_count;
+    struct {
+        uint32_t eot_level : 1;
+    } flags;
+} rmt_transmit_config_t;
+
+typedef struct {
+    rmt_tx_done_callback_t on_trans_done;
+} rmt_tx_event_callbacks_t;
+
+/**
+ * Host mock of an RMT TX channel. A thread takes the queued transactions in order, waits @ref mock_rmt::wire_time_us
+ * for each, records the bytes that went out in @ref mock_rmt::wire, and then calls `on_trans_done`, like the interrupt.
+ * Simple encoders are run half a memory block at a time, @ref mock_rmt::refill_time_us apart. Anything that would
+ * corrupt a real transmission is counted in @ref mock_rmt::errors.
+ */
+namespace mock_rmt {
+    inline std::atomic<int> wire_time_us{0};
+    inline std::atomic<int> refill_time_us{0};
+    /**
+     * Transactions whose data changed while in flight (except for simple encoders, which may read anything), simple
+     * encoders that stalled, copied symbols without a reset, and channels deleted with transactions pending.
+     */
+    inline std::atomic<int> errors{0};
+    inline std::atomic<int> completed{0};
+
+    inline std::mutex wire_mutex{};
+    inline std::vector<std::vector<std::uint8_t>> wire{};
+
+    inline void reset(int wire_time = 0, int refill_time = 0) {
+        wire_time_us = wire_time;
+        refill_time_us = refill_time;
+        errors = 0;
+        completed = 0;
+        const std::lock_guard lock{wire_mutex};
+        wire.clear();
+    }
+
+    [[nodiscard]] inline std::vector<std::vector<std::uint8_t>> sent_frames() {
+        const std::lock_guard lock{wire_mutex};
+        return wire;
+    }
+
+    /**
+     * Turns symbols back into bytes, MSB first: a bit is 1 if it is high longer than it is low. Symbols starting low,
+     * such as the reset, carry no data.
+     */
+    inline void decode_symbols(rmt_symbol_word_t const *symbols, std::size_t n, std::vector<std::uint8_t> &bytes, std::size_t &bits) {
+        for (std::size_t i = 0; i < n; ++i) {
+            if (not symbols[i].level0) {
+                continue;
+            }
+            if (bits++ % 8 == 0) {
+                bytes.push_back(0);
+            }
+            bytes.back() = std::uint8_t((bytes.back() << 1) | (symbols[i].duration0 > symbols[i].duration1 ? 1 : 0));
+        }
+    }
+
+    struct transaction {
+        rmt_encoder_handle_t encoder;
+        std::uint8_t const *data;
+        std::size_t size;
+        std::vector<std::uint8_t> snapshot;
+    };
+}// namespace mock_rmt
+
+struct rmt_channel_t {
+    std::mutex mutex{};
+    std::condition_variable cv{};
+    std::deque<mock_rmt::transaction> queue{};
+    std::size_t queue_depth = 4;
+    std::size_t mem_block_symbols = 64;
+    bool enabled = false;
+    bool stop = false;
+    rmt_tx_done_callback_t on_trans_done = nullptr;
+    void *user_ctx = nullptr;
+    std::thread thread{};
+
+    [[nodiscard]] std::vector<std::uint8_t> run_simple(mock_rmt::encoder const &enc, mock_rmt::transaction const &t) {
+        const std::size_t refill = std::max(mem_block_symbols / 2, enc.simple.min_chunk_size);
+        std::vector<rmt_symbol_word_t> block(refill);
+        std::vector<std::uint8_t> bytes{};
+        std::size_t bits = 0;
+        std::size_t written = 0;
+        bool done = false;
+        while (not done) {
+            std::this_thread::sleep_for(std::chrono::microseconds{mock_rmt::refill_time_us.load()});
+            const std::size_t n = enc.simple.callback(t.data, t.size, written, refill, block.data(), &done, enc.simple.arg);
+            if (n == 0 and not done) {
+                ++mock_rmt::errors;
+                break;
+            }
+            mock_rmt::decode_symbols(block.data(), n, bytes, bits);
+            written += n;
+        }
+        return bytes;
+    }
+
+    [[nodiscard]] std::vector<std::uint8_t> run(mock_rmt::transaction const &t) {
+        mock_rmt::encoder const *enc = mock_rmt::find_encoder(t.encoder);
+        if (enc != nullptr and enc->kind == mock_rmt::encoder_kind::simple) {
+            return run_simple(*enc, t);
+        }
+        if (std::memcmp(t.data, t.snapshot.data(), t.size) != 0) {
+            ++mock_rmt::errors;
+        }
+        if (enc != nullptr and enc->kind == mock_rmt::encoder_kind::copy) {
+            auto const *symbols = reinterpret_cast<rmt_symbol_word_t const *>(t.data);
+            const std::size_t n = t.size / sizeof(rmt_symbol_word_t);
+            if (n == 0 or symbols[n - 1].level0) {
+                ++mock_rmt::errors;
+            }
+            std::vector<std::uint8_t> bytes{};
+            std::size_t bits = 0;
+            mock_rmt::decode_symbols(symbols, n, bytes, bits);
+            return bytes;
+        }
+        return {t.data, t.data + t.size};
+    }
+
+    void body() {
+        std::unique_lock lock{mutex};
+        while (true) {
+            cv.wait(lock, [&] { return stop or not queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            // The front stays queued, hence owned by the driver, until it is done
+            mock_rmt::transaction const &t = queue.front();
+            lock.unlock();
+            std::this_thread::sleep_for(std::chrono::microseconds{mock_rmt::wire_time_us.load()});
+            std::vector<std::uint8_t> bytes = run(t);
+            {
+                const std::lock_guard wire_lock{mock_rmt::wire_mutex};
+                mock_rmt::wire.push_back(std::move(bytes));
+            }
+            if (on_trans_done != nullptr) {
+                const rmt_tx_done_event_data_t edata{.num_symbols = t.size};
+                on_trans_done(this, &edata, user_ctx);
+            }
+            lock.lock();
+            queue.pop_front();
+            ++mock_rmt::completed;
+            cv.notify_all();
+        }
+    }
+};
+
+inline esp_err_t rmt_new_tx_channel(const rmt_tx_channel_config_t *config, rmt_channel_handle_t *ret_chan) {
+    auto *chn = new rmt_channel_t{};
+    chn->queue_depth = config->trans_queue_depth;
+    chn->mem_block_symbols = config->mem_block_symbols;
+    chn->thread = std::thread{[chn] { chn->body(); }};
+    *ret_chan = chn;
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_del_channel(rmt_channel_handle_t chn) {
+    {
+        const std::lock_guard lock{chn->mutex};
+        if (not chn->queue.empty()) {
+            ++mock_rmt::errors;
+        }
+        chn->stop = true;
+    }
+    chn->cv.notify_all();
+    chn->thread.join();
+    delete chn;
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_enable(rmt_channel_handle_t chn) {
+    chn->enabled = true;
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_disable(rmt_channel_handle_t chn) {
+    chn->enabled = false;
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_tx_register_event_callbacks(rmt_channel_handle_t chn, const rmt_tx_event_callbacks_t *cbs, void *user_data) {
+    if (chn->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    chn->on_trans_done = cbs->on_trans_done;
+    chn->user_ctx = user_data;
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_transmit(rmt_channel_handle_t chn, rmt_encoder_handle_t encoder, const void *payload, size_t payload_bytes,
+                              const rmt_transmit_config_t *) {
+    if (not chn->enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    auto const *data = static_cast<std::uint8_t const *>(payload);
+    std::unique_lock lock{chn->mutex};
+    // Blocks while the queue is full, like with the default configuration
+    chn->cv.wait(lock, [&] { return chn->queue.size() < chn->queue_depth; });
+    chn->queue.push_back({encoder, data, payload_bytes, {data, data + payload_bytes}});
+    chn->cv.notify_all();
+    return ESP_OK;
+}
+
+inline esp_err_t rmt_tx_wait_all_done(rmt_channel_handle_t chn, int) {
+    std::unique_lock lock{chn->mutex};
+    chn->cv.wait(lock, [&] { return chn->queue.empty(); });
+    return ESP_OK;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <esp_err.h>
+
+typedef struct rmt_channel_t *rmt_channel_handle_t;
+
+typedef union {
+    struct {
+        uint32_t duration0 : 15;
+        uint32_t level0 : 1;
+        uint32_t duration1 : 15;
+        uint32_t level1 : 1;
+    };
+    uint32_t val;
+} rmt_symbol_word_t;
+
+typedef enum {
+    RMT_CLK_SRC_DEFAULT
+} rmt_clock_source_t;
+
+typedef struct {
+    size_t num_symbols;
+} rmt_tx_done_event_data_t;
+
+typedef bool (*rmt_tx_done_callback_t)(rmt_channel_handle_t tx_chan, const rmt_tx_done_event_data_t *edata, void *user_ctx);
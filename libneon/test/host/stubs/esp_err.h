@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+
+inline const char *esp_err_to_name(esp_err_t) {
+    return "esp_err_t";
+}
+
+#define ESP_ERROR_CHECK(x)                                                         \
+    do {                                                                           \
+        const esp_err_t err_ = (x);                                                \
+        if (err_ != ESP_OK) {                                                      \
+            std::fprintf(stderr, "%s:%d: %s failed: %d\n", __FILE__, __LINE__, #x, err_); \
+            std::abort();                                                          \
+        }                                                                          \
+    } while (0)
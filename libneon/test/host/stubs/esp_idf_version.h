@@ -0,0 +1,16 @@
+#pragma once
+
+// Host stub of the ESP-IDF version header; override the version with -DESP_IDF_VERSION_MINOR=... etc.
+
+#ifndef ESP_IDF_VERSION_MAJOR
+#define ESP_IDF_VERSION_MAJOR 5
+#endif
+#ifndef ESP_IDF_VERSION_MINOR
+#define ESP_IDF_VERSION_MINOR 3
+#endif
+#ifndef ESP_IDF_VERSION_PATCH
+#define ESP_IDF_VERSION_PATCH 0
+#endif
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION ESP_IDF_VERSION_VAL(ESP_IDF_VERSION_MAJOR, ESP_IDF_VERSION_MINOR, ESP_IDF_VERSION_PATCH)
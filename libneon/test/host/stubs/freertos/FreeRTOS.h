@@ -0,0 +1,19 @@
+#pragma once
+#include <cstdint>
+#include "sdkconfig.h"
+#include "esp_err.h"
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+typedef void *SemaphoreHandle_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffu
+#define tskNO_AFFINITY 0x7fffffff
+#define portPRIVILEGE_BIT 0
+#define portNUM_PROCESSORS 2
+#define pdMS_TO_TICKS(x) (x)
+#define portYIELD_FROM_ISR(...)
+inline BaseType_t xPortInIsrContext() { return pdFALSE; }
@@ -0,0 +1,16 @@
+#pragma once
+#include "FreeRTOS.h"
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+struct mock_sem { std::mutex m; std::condition_variable cv; unsigned count = 0, max = 1; };
+inline SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t mx, UBaseType_t init) { auto *s = new mock_sem; s->max = mx; s->count = init; return s; }
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new mock_sem; }
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t h, TickType_t t) {
+    auto *s = (mock_sem *) h; std::unique_lock l{s->m};
+    auto pred = [&] { return s->count > 0; };
+    if (t == portMAX_DELAY) s->cv.wait(l, pred); else if (!s->cv.wait_for(l, std::chrono::milliseconds(t), pred)) return pdFALSE;
+    --s->count; return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t h) { auto *s = (mock_sem *) h; { std::lock_guard l{s->m}; if (s->count < s->max) ++s->count; } s->cv.notify_all(); return pdTRUE; }
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t h, BaseType_t *w) { if (w) *w = pdFALSE; return xSemaphoreGive(h); }
+inline void vSemaphoreDelete(SemaphoreHandle_t h) { delete (mock_sem *) h; }
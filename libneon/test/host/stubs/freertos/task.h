@@ -0,0 +1,14 @@
+#pragma once
+#include "FreeRTOS.h"
+typedef void (*TaskFunction_t)(void *);
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *, UBaseType_t, TaskHandle_t *h, BaseType_t) { static int x; *h = &x; return pdPASS; }
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 1; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t *) {}
+inline void xTaskNotifyGive(TaskHandle_t) {}
+inline void vTaskDelete(TaskHandle_t) {}
+inline void vTaskPrioritySet(TaskHandle_t, UBaseType_t) {}
+inline void vTaskSuspend(TaskHandle_t) {}
+inline int xPortGetCoreID() { return 0; }
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return nullptr; }
+#include <chrono>
+inline TickType_t xTaskGetTickCount() { return TickType_t(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()); }
@@ -0,0 +1,4 @@
+#pragma once
+
+#define CONFIG_ESP_TIMER_TASK_STACK_SIZE 3584
+#define CONFIG_FREERTOS_NUMBER_OF_CORES 2
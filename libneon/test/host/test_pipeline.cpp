@@ -0,0 +1,127 @@
+/**
+ * Pipelined transmission through led_encoder's buffers, against the mock RMT driver: each frame goes out as it was
+ * submitted even if the next ones are rendered while it is on the wire, and on_transmit_done runs once per frame.
+ */
+#include "check.hpp"
+#include <neo/encoder.hpp>
+#include <neo/fx.hpp>
+
+using namespace std::chrono_literals;
+using namespace neo::literals;
+
+namespace {
+    std::atomic<std::uint32_t> done_calls = 0;
+    std::atomic<std::uint32_t> last_done = 0;
+    std::atomic<bool> done_in_order = true;
+
+    bool on_done(std::uint32_t frame, void *) {
+        if (frame != last_done + 1) {
+            done_in_order = false;
+        }
+        last_done = frame;
+        ++done_calls;
+        return false;
+    }
+
+    [[nodiscard]] std::vector<std::uint8_t> grb_bytes(std::vector<neo::srgb> const &colors) {
+        std::vector<std::uint8_t> bytes{};
+        for (neo::srgb const &c : colors) {
+            bytes.insert(std::end(bytes), {c.g, c.r, c.b});
+        }
+        return bytes;
+    }
+
+    void check_buffers(std::size_t num_buffers) {
+        constexpr std::uint32_t num_frames = 60;
+        mock_rmt::reset(2000);
+        done_calls = 0;
+        last_done = 0;
+        done_in_order = true;
+        std::vector<std::vector<std::uint8_t>> expected{};
+        std::uint32_t max_in_flight = 0;
+        {
+            neo::led_encoder enc{neo::encoding::ws2812b, neo::make_rmt_config(GPIO_NUM_13), num_buffers};
+            enc.set_on_transmit_done(&on_done);
+            std::vector<neo::srgb> colors(100);
+            neo::tracked_buffer<neo::srgb> tracked{colors.size()};
+            for (std::uint32_t f = 0; f < num_frames; ++f) {
+                for (std::size_t i = 0; i < colors.size(); ++i) {
+                    colors[i] = neo::srgb{std::uint8_t(f + i), std::uint8_t(3 * f), std::uint8_t(i)};
+                }
+                // Alternate full frames and incremental ones, which reuse the bytes of older frames
+                if (f % 2 == 0) {
+                    ESP_ERROR_CHECK(enc.transmit(std::begin(colors), std::end(colors)));
+                    expected.push_back(grb_bytes(colors));
+                } else {
+                    tracked.set(f % colors.size(), colors[f % colors.size()]);
+                    tracked.set((7 * f) % colors.size(), colors[3]);
+                    ESP_ERROR_CHECK(enc.transmit(tracked));
+                    expected.push_back(grb_bytes({std::begin(tracked.colors()), std::end(tracked.colors())}));
+                }
+                max_in_flight = std::max(max_in_flight, enc.last_frame() - last_done);
+            }
+            CHECK(enc.last_frame() == num_frames);
+            CHECK(enc.wait_done(num_frames + 1, 20ms) == ESP_ERR_TIMEOUT);
+            ESP_ERROR_CHECK(enc.wait_all_done());
+            CHECK(enc.is_done(num_frames));
+        }
+        CHECK(mock_rmt::errors == 0);
+        CHECK(mock_rmt::sent_frames() == expected);
+        CHECK(done_calls == num_frames);
+        CHECK(done_in_order);
+        // Each buffer holds a frame until it is transmitted, and with more buffers, frames overlap
+        CHECK(max_in_flight <= num_buffers);
+        CHECK(num_buffers == 1 or max_in_flight >= 2);
+    }
+
+    void check_callback() {
+        mock_rmt::reset(3000);
+        {
+            neo::led_encoder enc{neo::encoding::ws2812b, neo::make_rmt_config(GPIO_NUM_13), 2};
+            auto fx = neo::wrap(neo::hue_rotate_fx{1s});
+            auto cb = fx->make_callback(enc, 200);
+            neo::alarm a{30_fps, [](neo::alarm &) {}};
+            for (int i = 0; i < 20; ++i) {
+                cb(a);
+            }
+            CHECK(enc.last_frame() == 20);
+        }
+        CHECK(mock_rmt::completed == 20);
+        CHECK(mock_rmt::errors == 0);
+    }
+
+    void check_move() {
+        mock_rmt::reset(2000);
+        std::vector<neo::srgb> colors(100, neo::srgb{1, 2, 3});
+        {
+            neo::led_encoder a{neo::encoding::ws2812b, neo::make_rmt_config(GPIO_NUM_13)};
+            neo::led_encoder b{neo::encoding::ws2812b, neo::make_rmt_config(GPIO_NUM_13), 3};
+            for (int i = 0; i < 3; ++i) {
+                ESP_ERROR_CHECK(a.transmit(std::begin(colors), std::end(colors)));
+                ESP_ERROR_CHECK(b.transmit(std::begin(colors), std::end(colors)));
+            }
+            // Both have frames in flight, which refer to their address
+            a = std::move(b);
+            neo::led_encoder c{std::move(a)};
+            // The moved-from encoder is usable, and has nothing in flight
+            ESP_ERROR_CHECK(a.wait_free_buffer());
+            ESP_ERROR_CHECK(a.wait_all_done());
+            for (int i = 0; i < 3; ++i) {
+                ESP_ERROR_CHECK(c.transmit(std::begin(colors), std::end(colors)));
+            }
+            CHECK(c.num_buffers() == 3);
+            CHECK(c.last_frame() == 6);
+        }
+        CHECK(mock_rmt::completed == 9);
+        CHECK(mock_rmt::errors == 0);
+    }
+}// namespace
+
+int main() {
+    for (std::size_t num_buffers : {1, 2, 3}) {
+        check_buffers(num_buffers);
+    }
+    check_callback();
+    check_move();
+    return check::summary("test_pipeline");
+}